@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -6,6 +9,7 @@
 #include <variant>
 #include <raylib.h>
 #include <raymath.h>
+#include "../../EngineWithEditor/EngineWithEditor/Debug.Trace.h"
 
 using byte = unsigned char;
 
@@ -34,8 +38,9 @@ namespace std
 	{
 		size_t operator()(const Vector2Int& x) const
 		{
-			int32_t value = (x.x << sizeof(decltype(x.y))) | x.y;
-			return hash<int32_t>()(value);
+			// Each coordinate gets its own 16 bits; shifting by sizeof (bytes, not bits) made most positions collide
+			uint32_t value = ((uint32_t)(uint16_t)x.x << 16) | (uint16_t)x.y;
+			return hash<uint32_t>()(value);
 		}
 	};
 }
@@ -245,18 +250,144 @@ class Object;
 using Objects_t = std::vector<Object*>;
 Objects_t world;
 
-using Grid_t = std::unordered_map<Vector2Int, Objects_t>;
-Grid_t grid;
+// Dense tile grid of the objects in each cell, for levels up to maxSize cells on a side.
+// Cells are grouped into chunks, which are only allocated once something is placed in them,
+// so finding a cell, or any of its neighbours, is two array lookups.
+class Grid
+{
+public:
+	static constexpr int chunkBits = 4;
+	static constexpr int chunkSize = 1 << chunkBits;
+	static constexpr int maxSize = 4096;
+
+	// The objects in one cell, in the order they were added. Only valid until the grid next changes.
+	class Cell
+	{
+	private:
+		Object* const* first = nullptr;
+		Object* const* last = nullptr;
+
+	public:
+		Cell() = default;
+		Cell(Object* const* first, Object* const* last) : first(first), last(last) {}
+
+		Object* const* begin() const { return first; }
+		Object* const* end() const { return last; }
+		size_t size() const { return (size_t)(last - first); }
+		bool empty() const { return first == last; }
+	};
+
+private:
+	static constexpr int chunksPerSide = maxSize / chunkSize;
+	static constexpr int cellsPerChunk = chunkSize * chunkSize;
+
+	// Each cell's objects are a short run of one array per chunk, rather than a list per cell,
+	// so an empty cell costs two bytes and a full level of them stays small
+	struct Chunk
+	{
+		uint16_t ends[cellsPerChunk] = {}; // One past each cell's last object in objects
+		std::vector<Object*> objects;      // Grouped by cell, in cell order
+
+		size_t Begin(size_t cell) const { return cell ? ends[cell - 1] : 0; }
+	};
+	std::vector<std::unique_ptr<Chunk>> chunks = std::vector<std::unique_ptr<Chunk>>(chunksPerSide * chunksPerSide);
 
-Objects_t* ObjectAtPosition(Vector2Int pos)
+	static size_t ChunkIndex(Vector2Int pos) { return (size_t)(pos.y >> chunkBits) * chunksPerSide + (size_t)(pos.x >> chunkBits); }
+	static size_t CellIndex(Vector2Int pos) { return (size_t)(pos.y & (chunkSize - 1)) * chunkSize + (size_t)(pos.x & (chunkSize - 1)); }
+
+public:
+	static bool Contains(Vector2Int pos)
+	{
+		return 0 <= pos.x && pos.x < maxSize && 0 <= pos.y && pos.y < maxSize;
+	}
+
+	// The objects at pos; empty outside the grid
+	Cell At(Vector2Int pos) const
+	{
+		if (!Contains(pos)) return {};
+		const Chunk* chunk = chunks[ChunkIndex(pos)].get();
+		if (!chunk) return {};
+		size_t cell = CellIndex(pos);
+		Object* const* objects = chunk->objects.data();
+		return { objects + chunk->Begin(cell), objects + chunk->ends[cell] };
+	}
+
+	// Costs at most one shift of the chunk's later objects and cell ends
+	void Add(Vector2Int pos, Object* object)
+	{
+		_ASSERT_EXPR(Contains(pos), L"Position is outside the grid");
+		std::unique_ptr<Chunk>& chunk = chunks[ChunkIndex(pos)];
+		if (!chunk) chunk = std::make_unique<Chunk>();
+		_ASSERT_EXPR(chunk->objects.size() < UINT16_MAX, L"Too many objects in one chunk");
+		size_t cell = CellIndex(pos);
+		chunk->objects.insert(chunk->objects.begin() + chunk->ends[cell], object);
+		for (size_t i = cell; i < cellsPerChunk; ++i)
+		{
+			++chunk->ends[i];
+		}
+	}
+	void Remove(Vector2Int pos, Object* object)
+	{
+		_ASSERT_EXPR(Contains(pos) && chunks[ChunkIndex(pos)], L"Object is not in the grid");
+		Chunk& chunk = *chunks[ChunkIndex(pos)];
+		size_t cell = CellIndex(pos);
+		auto first = chunk.objects.begin() + chunk.Begin(cell);
+		auto it = std::find(first, chunk.objects.begin() + chunk.ends[cell], object);
+		_ASSERT_EXPR(it != chunk.objects.begin() + chunk.ends[cell], L"Object is not in this cell");
+		chunk.objects.erase(it);
+		for (size_t i = cell; i < cellsPerChunk; ++i)
+		{
+			--chunk.ends[i];
+		}
+	}
+
+	// Empties every cell, keeping chunks allocated for reuse
+	void Clear()
+	{
+		for (std::unique_ptr<Chunk>& chunk : chunks)
+		{
+			if (!chunk || chunk->objects.empty()) continue;
+			chunk->objects.clear();
+			std::fill(std::begin(chunk->ends), std::end(chunk->ends), (uint16_t)0);
+		}
+	}
+};
+Grid grid;
+
+// The objects at pos, if any
+Grid::Cell ObjectAtPosition(Vector2Int pos)
 {
-	auto it = grid.find(pos);
-	return (it != grid.end()) ? &it->second : nullptr;
+	return grid.At(pos);
 };
 
 using Types_t = std::unordered_map<Noun, Objects_t>;
 Types_t types;
 
+// Objects that moved this Step and where from. The grid is only updated once everything has moved,
+// so every object decides its move against the same grid.
+struct Move
+{
+	Object* object;
+	Vector2Int from;
+};
+std::vector<Move> moves;
+
+// Cells text was created, destroyed, moved or converted in since the rules were last read
+std::unordered_set<Vector2Int> changedText;
+
+// Rules are read along lines of adjacent text cells, rightwards and downwards
+constexpr Vector2Int readingDirections[] = { { 1, 0 }, { 0, 1 } };
+
+// A line of adjacent text cells and the rules read from it. Only lines with rules are kept,
+// and a line is only read again once text changes in one of its cells or next to either end.
+struct TextLine
+{
+	int length;
+	std::vector<Rule> rules;
+};
+std::unordered_map<Vector2Int, TextLine> textLines[2];          // By first cell, per reading direction
+std::unordered_map<Vector2Int, Vector2Int> textLineStarts[2]; // Every cell of a kept line to its first cell
+
 class Object
 {
 	Noun meta;
@@ -264,26 +395,52 @@ class Object
 	byte rotation : 2; // 90-degree clockwise increments
 	Vector2Int position;
 	Vector2Int velocity; // Delta position this Step
+	size_t typeIndex; // In types[meta]
 
 	Object(Noun meta, Word text, int rotation, int x, int y) :
 		meta(meta), text(text), rotation(rotation & 3), position{ (short)x,(short)y }, velocity{ 0,0 } {}
 
+	// Objects keep grid and types up to date themselves, so Step only touches what changed
+	void AddToType()
+	{
+		Objects_t& objects = types[meta];
+		typeIndex = objects.size();
+		objects.push_back(this);
+		if (IsText()) changedText.insert(position);
+	}
+	void RemoveFromType()
+	{
+		Objects_t& objects = types[meta];
+		_ASSERT_EXPR(typeIndex < objects.size() && objects[typeIndex] == this, L"Object is not in its type");
+		objects[typeIndex] = objects.back();
+		objects[typeIndex]->typeIndex = typeIndex;
+		objects.pop_back();
+		if (IsText()) changedText.insert(position);
+	}
+	static Object* Track(Object* object)
+	{
+		world.push_back(object);
+		grid.Add(object->position, object);
+		object->AddToType();
+		return object;
+	}
+
 public:
 	static Object* CreateObject(Noun meta, int rotation, int x, int y)
 	{
-		world.push_back(new Object(meta, (Word)0, rotation, x, y));
-		return world.back();
+		return Track(new Object(meta, (Word)0, rotation, x, y));
 	}
 	static Object* CreateText(Word meta, int rotation, int x, int y)
 	{
-		world.push_back(new Object(Noun::TEXT, meta, rotation, x, y ));
-		return world.back();
+		return Track(new Object(Noun::TEXT, meta, rotation, x, y ));
 	}
 	static void DestroyObject(Object*& what)
 	{
 		auto it = std::find(world.begin(), world.end(), what);
 		_ASSERT_EXPR(it != world.end(), L"Cannot remove missing element");
 		world.erase(it);
+		grid.Remove(what->position, what);
+		what->RemoveFromType();
 		delete what;
 		what = nullptr;
 	}
@@ -294,6 +451,15 @@ public:
 			delete obj;
 		}
 		world.clear();
+		grid.Clear();
+		types.clear();
+		moves.clear();
+		changedText.clear();
+		for (int direction = 0; direction < 2; ++direction)
+		{
+			textLines[direction].clear();
+			textLineStarts[direction].clear();
+		}
 	}
 
 	Vector2Int Position() const { return position; }
@@ -360,7 +526,10 @@ public:
 
 	void Is(Noun what)
 	{
+		if (what == meta) return;
+		RemoveFromType();
 		meta = what;
+		AddToType();
 	}
 
 	// Called after all rules are applied
@@ -408,11 +577,11 @@ public:
 				position.x + offset.x,
 				position.y + offset.y
 			};
-			Objects_t* objects = ObjectAtPosition(space);
-			if (!objects) continue;
-			for (Object* object : *objects)
+			Grid::Cell objects = ObjectAtPosition(space);
+			for (Object* object : objects)
 			{
 				Ruleset_t* spaceRules = object->Rules();
+				if (!spaceRules) continue;
 				for (const Rule& rule : *spaceRules)
 				{
 					if (!rule.IsProperty()) continue;
@@ -430,6 +599,7 @@ public:
 						// @Todo: Win condition
 						break;
 					case Adjective::STOP:
+					{
 						// Blocking?
 						Vector2Int newPos =
 						{
@@ -442,6 +612,7 @@ public:
 							velocity.y = 0;
 						}
 						break;
+					}
 					case Adjective::DEFEAT:
 						// @Todo: Lose condition
 						break;
@@ -454,8 +625,19 @@ public:
 			}
 		}
 
-		position.x += velocity.x;
-		position.y += velocity.y;
+		// The edges of the grid stop everything
+		if (!Grid::Contains({ position.x + velocity.x, position.y + velocity.y }))
+		{
+			velocity.x = 0;
+			velocity.y = 0;
+		}
+
+		if (velocity.x || velocity.y)
+		{
+			moves.push_back({ this, position });
+			position.x += velocity.x;
+			position.y += velocity.y;
+		}
 
 		// Has is applied after destruction
 		if (destroyedThisStep)
@@ -469,112 +651,256 @@ public:
 	}
 };
 
-void Step()
+bool HasText(Vector2Int pos)
 {
-	// Map objects in world
-	grid.clear();
-	for (Object* obj : world)
+	for (Object* obj : ObjectAtPosition(pos))
 	{
-		Vector2Int pos = obj->Position();
-		grid[pos].push_back(obj);
+		if (obj->IsText()) return true;
 	}
+	return false;
+}
 
-	// Create rules
-	ruleset.clear();
-	// Top-leftmost gets highest precedence 
-	for (Object* obj : world)
+// The first text at pos whose word fits, if any. Stacked text can be read as any of its words.
+template<class Fits>
+Object* FindWord(Vector2Int pos, Fits fits)
+{
+	for (Object* obj : ObjectAtPosition(pos))
+	{
+		if (obj->IsText() && fits(obj)) return obj;
+	}
+	return nullptr;
+}
+bool IsAnd(const Object* obj)
+{
+	return obj->IsVerb() && obj->AsVerb() == Verb::AND;
+}
+
+// Reads the sentence NOUN [AND NOUN]... IS|HAS VALUE [AND VALUE]... starting at cells[first] into rules.
+// Returns how many cells its subjects span, or 0 if no sentence starts there.
+size_t ReadSentence(const std::vector<Vector2Int>& cells, size_t first, std::vector<Rule>& rules)
+{
+	auto isNoun = [](const Object* obj) { return obj->IsNoun(); };
+
+	std::vector<Noun> subjects;
+	size_t i = first;
+	for (;;)
 	{
-		// Cannot evaluate starting from verbs nor adjectives
-		if (!obj->IsNoun())
-			continue;
+		Object* subject = i < cells.size() ? FindWord(cells[i], isNoun) : nullptr;
+		if (!subject) return 0;
+		subjects.push_back(subject->AsNoun());
+		++i;
+		if (i + 1 >= cells.size() || !FindWord(cells[i], IsAnd) || !FindWord(cells[i + 1], isNoun)) break;
+		++i;
+	}
+	size_t subjectsEnd = i;
 
-		auto [x, y] = obj->Position();
+	Object* verb = i < cells.size() ? FindWord(cells[i], [](const Object* obj) { return obj->IsVerb() && !IsAnd(obj); }) : nullptr;
+	if (!verb) return 0;
+	Verb action = verb->AsVerb();
+	++i;
 
-		do
+	// Only values the verb can take, so NOUN HAS YOU is no sentence
+	auto isValue = [&](const Object* obj)
+	{
+		if (obj->IsNoun()) return Rule{ subjects[0], action, obj->AsNoun() }.IsValid();
+		if (obj->IsAdjective()) return Rule{ subjects[0], action, obj->AsAdjective() }.IsValid();
+		return false;
+	};
+	size_t firstRule = rules.size();
+	for (;;)
+	{
+		Object* value = i < cells.size() ? FindWord(cells[i], isValue) : nullptr;
+		if (!value) break;
+		NounOrAdjective_t word = value->IsNoun() ? NounOrAdjective_t{ value->AsNoun() } : NounOrAdjective_t{ value->AsAdjective() };
+		for (Noun subject : subjects)
 		{
-			Objects_t* rightSpace1 = ObjectAtPosition({ x + 1, y });
-			if (!rightSpace1) break;
+			rules.push_back({ subject, action, word });
+		}
+		++i;
+		if (i + 1 >= cells.size() || !FindWord(cells[i], IsAnd)) break;
+		++i;
+	}
+	return rules.size() > firstRule ? subjectsEnd - first : 0;
+}
 
-			Objects_t* rightSpace2 = ObjectAtPosition({ x + 2, y });
-			if (!rightSpace2) break;
+void ForgetTextLine(int direction, Vector2Int start)
+{
+	auto it = textLines[direction].find(start);
+	if (it == textLines[direction].end()) return;
+	Vector2Int step = readingDirections[direction];
+	for (int i = 0; i < it->second.length; ++i)
+	{
+		textLineStarts[direction].erase({ start.x + step.x * i, start.y + step.y * i });
+	}
+	textLines[direction].erase(it);
+}
 
-			Object* right1 = nullptr;
-			for (Object* what : *rightSpace1)
-			{
-				if (what->IsVerb())
-				{
-					right1 = what;
-					break;
-				}
-			}
-			if (!right1) break;
+// Reads every sentence in the line of text starting at start, keeping the line if it has any
+void ReadTextLine(int direction, Vector2Int start)
+{
+	ForgetTextLine(direction, start);
+	Vector2Int step = readingDirections[direction];
+	std::vector<Vector2Int> cells;
+	for (Vector2Int pos = start; HasText(pos); pos = { pos.x + step.x, pos.y + step.y })
+	{
+		cells.push_back(pos);
+	}
+
+	TextLine line = { (int)cells.size(), {} };
+	// A sentence can start at any noun but the later subjects of another, so BABA IS KEY IS YOU reads as two
+	size_t subjectsEnd = 0;
+	for (size_t i = 0; i < cells.size(); ++i)
+	{
+		if (i < subjectsEnd) continue;
+		size_t subjects = ReadSentence(cells, i, line.rules);
+		if (subjects) subjectsEnd = i + subjects;
+	}
+	if (line.rules.empty()) return;
 
-			Object* right2 = nullptr;
-			for (Object* what : *rightSpace2)
+	for (Vector2Int cell : cells)
+	{
+		textLineStarts[direction][cell] = start;
+	}
+	textLines[direction][start] = std::move(line);
+}
+
+// Re-reads the lines of text changedText touched, then gathers the rules of every line into ruleset
+void ReadRules()
+{
+	for (int direction = 0; direction < 2; ++direction)
+	{
+		Vector2Int step = readingDirections[direction];
+		std::unordered_set<Vector2Int> starts;
+		for (Vector2Int cell : changedText)
+		{
+			// Text changing in a cell can split, join, lengthen or shorten the lines through it and either side of it
+			for (int offset = -1; offset <= 1; ++offset)
 			{
-				if (what->IsNoun() || what->IsAdjective())
+				Vector2Int pos = { cell.x + step.x * offset, cell.y + step.y * offset };
+				auto old = textLineStarts[direction].find(pos);
+				if (old != textLineStarts[direction].end()) ForgetTextLine(direction, old->second);
+				if (!HasText(pos)) continue;
+				Vector2Int start = pos;
+				while (HasText({ start.x - step.x, start.y - step.y }))
 				{
-					right2 = what;
-					break;
+					start = { start.x - step.x, start.y - step.y };
 				}
+				starts.insert(start);
 			}
-			if (!right2) break;
-
-			// @Todo: "AND" linkage
-			// @Todo: Validation
-
-			Rule rule;
-			rule.target = obj->AsNoun();
-			rule.action = right1->AsVerb();
-			rule.value = right2->IsNoun() ? NounOrAdjective_t{ right2->AsNoun() } : NounOrAdjective_t{ right2->AsAdjective() };
-			ruleset.push_back(rule);
 		}
-		while (false);
-
-		// @Todo: Vertical rules
+		for (Vector2Int start : starts)
+		{
+			ReadTextLine(direction, start);
+		}
 	}
+	changedText.clear();
 
-	// Map objects by type
-	types.clear();
-	for (Object* obj : world)
+	// Top-leftmost gets highest precedence, rows before columns
+	struct Source
+	{
+		Vector2Int start;
+		int direction;
+		const TextLine* line;
+	};
+	std::vector<Source> sources;
+	for (int direction = 0; direction < 2; ++direction)
+	{
+		for (const auto& [start, line] : textLines[direction])
+		{
+			sources.push_back({ start, direction, &line });
+		}
+	}
+	std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b)
 	{
-		Noun type = obj->What();
-		types[type].push_back(obj);
+		if (a.start.y != b.start.y) return a.start.y < b.start.y;
+		if (a.start.x != b.start.x) return a.start.x < b.start.x;
+		return a.direction < b.direction;
+	});
+	ruleset.clear();
+	for (const Source& source : sources)
+	{
+		ruleset.insert(ruleset.end(), source.line->rules.begin(), source.line->rules.end());
 	}
+}
 
-	// Apply type conversion rules
-	for (const Rule& rule : ruleset)
+// grid and types are kept up to date by the objects themselves, and only lines of text that changed are
+// re-read, so a Step costs in proportion to the objects that convert or move rather than the level
+void Step()
+{
+	DEBUG_TRACE_SCOPE("Step");
+
+	// Create rules
+	if (!changedText.empty())
 	{
-		auto it = types.find(rule.target);
-		if (it == types.end()) continue;
+		DEBUG_TRACE_SCOPE("Rules");
+		ReadRules();
+
+		// Map rules by type
+		typeRules.clear();
+		for (Rule rule : ruleset)
+		{
+			typeRules[rule.target].push_back(rule);
+		}
+	}
 
-		const Objects_t& objects = it->second;
-		for (Object* obj : objects)
+	// Apply type conversion rules.
+	// Each rule converts what was its target before any rule applied, so BABA IS WALL and WALL IS BABA swap them.
+	// Rules like BABA IS BABA change nothing and are skipped, and a target is only copied once however many rules convert it.
+	{
+		DEBUG_TRACE_SCOPE("Conversions");
+		Types_t snapshots;
+		std::vector<std::pair<Noun, Noun>> conversions;
+		for (const Rule& rule : ruleset)
 		{
-			if (rule.action == Verb::IS && std::holds_alternative<Noun>(rule.value))
-				obj->Is(std::get<Noun>(rule.value));
+			if (!rule.IsConversion() || rule.target == rule.GetConversionResult()) continue;
+			auto it = types.find(rule.target);
+			if (it == types.end() || it->second.empty()) continue;
+			snapshots.try_emplace(rule.target, it->second);
+			conversions.push_back({ rule.target, rule.GetConversionResult() });
+		}
+		for (const auto& [target, result] : conversions)
+		{
+			for (Object* obj : snapshots[target])
+			{
+				obj->Is(result);
+			}
 		}
 	}
-	// @Todo: The types map will be invalid ?????
 
-	// Map rules by type
-	typeRules.clear();
-	for (Rule rule : ruleset)
+	// Update objects according to rules. Only types with an active rule can move; everything else would stand still.
 	{
-		typeRules[rule.target].push_back(rule);
+		DEBUG_TRACE_SCOPE("Updates");
+		for (const auto& [type, rules] : typeRules)
+		{
+			if (std::none_of(rules.begin(), rules.end(), [](const Rule& rule) { return rule.IsActive(); })) continue;
+			auto it = types.find(type);
+			if (it == types.end()) continue;
+			for (Object* obj : it->second)
+			{
+				obj->Update();
+			}
+		}
 	}
 
-	// Update objects according to rules
-	for (Object* obj : world)
+	// Move what moved in the grid
+	DEBUG_TRACE_SCOPE("Grid moves");
+	Debug::TraceCounter("Moves", (double)moves.size());
+	for (const Move& move : moves)
 	{
-		obj->Update();
+		grid.Remove(move.from, move.object);
+		grid.Add(move.object->Position(), move.object);
+		if (move.object->IsText())
+		{
+			changedText.insert(move.from);
+			changedText.insert(move.object->Position());
+		}
 	}
+	moves.clear();
 }
 
-int main()
+void LoadLevel()
 {
-	InitWindow(1280, 720, "Code Game");
-	SetTargetFPS(60);
+	DEBUG_TRACE_SCOPE("Level setup");
 
 	Object::CreateText(Word::BABA, 0, 0,0);
 	Object::CreateText(Word::IS,   0, 1,0);
@@ -588,9 +914,32 @@ int main()
 	Object::CreateObject(Noun::WALL, 0, 9,5);
 
 	Step(); // Initialize
+}
+
+// Traces go to this file. Launching with --trace records from the start, so the level setup is in it;
+// F9 starts or stops a trace at any time after.
+constexpr const char* tracePath = "codegame.trace.json";
+
+int main(int argc, char** argv)
+{
+	Debug::TraceThreadName("Main");
+	if (argc > 1 && std::string(argv[1]) == "--trace") Debug::TraceStart(tracePath);
+
+	InitWindow(1280, 720, "Code Game");
+	SetTargetFPS(60);
+
+	LoadLevel();
 
 	while (!WindowShouldClose())
 	{
+		// Applied before the frame begins, so a trace never holds half a frame
+		if (IsKeyPressed(KEY_F9))
+		{
+			if (Debug::IsTracing()) Debug::TraceStop();
+			else Debug::TraceStart(tracePath);
+		}
+		Debug::TraceBegin("Frame");
+
 		{
 			bool up    = IsKeyPressed(KEY_W) || IsKeyPressed(KEY_UP);
 			bool down  = IsKeyPressed(KEY_S) || IsKeyPressed(KEY_DOWN);
@@ -624,9 +973,12 @@ int main()
 			y += 20;
 		}
 
+		Debug::TraceEnd("Frame");
+		Debug::TraceFlush();
 		EndDrawing();
 	}
 
+	Debug::TraceStop();
 	Object::Cleanup();
 
 	CloseWindow();
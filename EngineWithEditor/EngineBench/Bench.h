@@ -0,0 +1,87 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Bench
+{
+	struct Result
+	{
+		std::string name;
+		size_t iterations;
+		double nsPerOp;
+		// Extra numbers a benchmark wants tracked alongside its timing
+		std::vector<std::pair<std::string, double>> metrics;
+
+		Result& Metric(std::string key, double value)
+		{
+			metrics.emplace_back(std::move(key), value);
+			return *this;
+		}
+	};
+
+	// Keeps the compiler from optimizing away a value that is only computed to be timed
+	template<class _Ty>
+	inline void DoNotOptimize(const _Ty& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	class Context
+	{
+	private:
+		bool quick;
+		std::vector<Result> results;
+
+	public:
+		Context(bool quick) : quick(quick) {}
+
+		bool IsQuick() const { return quick; }
+		const std::vector<Result>& GetResults() const { return results; }
+
+		// Problem sizes shrink by 10x in quick mode, for smoke-testing the benchmarks themselves
+		size_t Scale(size_t full) const { return quick ? std::max<size_t>(full / 10, 1) : full; }
+
+		// Times body, which performs iterations operations, and records the fastest of repeats runs
+		Result& Run(std::string name, size_t iterations, const std::function<void()>& body, int repeats = 5)
+		{
+			using Clock = std::chrono::steady_clock;
+			if (quick) repeats = 1;
+
+			double best = std::numeric_limits<double>::infinity();
+			for (int i = 0; i < repeats; ++i)
+			{
+				Clock::time_point start = Clock::now();
+				body();
+				std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+				best = std::min(best, elapsed.count());
+			}
+
+			double nsPerOp = best / (double)std::max<size_t>(iterations, 1);
+			std::printf("%-44s %14.2f ns/op\n", name.c_str(), nsPerOp);
+			results.push_back({ std::move(name), iterations, nsPerOp, {} });
+			return results.back();
+		}
+	};
+
+	void RunMemory(Context& context);
+	void RunMath(Context& context);
+	void RunSpatial(Context& context);
+	void RunJobs(Context& context);
+	void RunScene(Context& context);
+	void RunProfiler(Context& context);
+	void RunTrace(Context& context);
+	void RunLog(Context& context);
+	// Only built when raylib is found (ENGINE_BENCH_EDITOR_UI)
+	void RunEditorUI(Context& context);
+}
@@ -0,0 +1,323 @@
+// Scripted EditorUI interactions drawn to a HeadlessDrawSink, so UI frame cost can be measured without a GPU
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Bench.h"
+#include "EditorUI.h"
+#include "EditorUI.Docking.h"
+#include "EditorUI.HeadlessDrawSink.h"
+#include "EditorUI.HitTest.h"
+#include "EditorUI.TreeView.h"
+#include "Engine.Profiler.h"
+
+using namespace EditorUI;
+
+namespace Bench
+{
+	// Ids no real texture or shader has, since nothing is loaded
+	constexpr unsigned int uiTextureId = 1;
+	constexpr unsigned int fontTextureId = 2;
+	constexpr unsigned int previewShaderId = 3;
+
+	constexpr float screenWidth = 1280;
+	constexpr float screenHeight = 720;
+
+	// What every scenario draws with: a headless sink, the UI's globals pointed at fake resources, and some panes
+	struct UIScene
+	{
+		HeadlessDrawSink sink;
+		HeadlessFont font{ fontTextureId };
+		DrawList drawList{ sink };
+		std::vector<std::string> names;
+		std::vector<std::unique_ptr<Pane>> panes;
+
+		UIScene(size_t paneCount)
+		{
+			uiTexture = { uiTextureId, gripPatternSize, gripPatternSize, 1, rl::PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+			previewShader = { previewShaderId, nullptr };
+			textCache.Clear();
+			textCache.SetDefaultFont(font.GetFont());
+			drawList.SetShapesTexture(uiTexture, { 0,0,1,1 });
+
+			names.reserve(paneCount);
+			for (size_t i = 0; i < paneCount; ++i)
+			{
+				names.push_back("Pane " + std::to_string(i));
+				panes.push_back(std::make_unique<Pane>(names.back().c_str(), i % 3 == 0));
+			}
+		}
+		~UIScene() { textCache.Clear(); }
+
+		// Tiles the panes across the screen, overlapping a little
+		void Scatter()
+		{
+			size_t columns = 10;
+			for (size_t i = 0; i < panes.size(); ++i)
+			{
+				float x = (float)(i % columns) * screenWidth / columns;
+				float y = (float)(i / columns) * 64;
+				panes[i]->SetRect({ x, y, screenWidth / columns + 20, 80 });
+			}
+		}
+
+		// Draws the panes as main.cpp does, minus the PaneCache, which needs render textures
+		void DrawFrame(const Pane* focused = nullptr, PaneInteractFlags flags = PaneInteractFlags(0))
+		{
+			sink.BeginFrame();
+			for (const std::unique_ptr<Pane>& pane : panes)
+			{
+				if (pane.get() == focused) pane->DrawFocused(drawList, flags);
+				else pane->Draw(drawList);
+			}
+			drawList.Submit();
+			textCache.EvictUnused(textCacheMaxAge);
+		}
+	};
+
+	static void AddFrameMetrics(Result& result, const HeadlessDrawSink::FrameStats& stats)
+	{
+		result
+			.Metric("drawCalls", (double)stats.drawCalls)
+			.Metric("primitives", (double)stats.primitives)
+			.Metric("stateChanges", (double)stats.GetStateChanges())
+			.Metric("bytes", (double)stats.bytes);
+	}
+
+	static void RunIdle(Context& context, size_t frames)
+	{
+		UIScene scene(100);
+		scene.Scatter();
+		Result& result = context.Run("editorui/idle 100 panes (frame)", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				scene.DrawFrame();
+			}
+		});
+		AddFrameMetrics(result, scene.sink.GetFrameStats());
+	}
+
+	// The idle frame with the profiler recording, as the editor runs it, including the frame's EndFrame
+	static void RunProfiledIdle(Context& context, size_t frames)
+	{
+		UIScene scene(100);
+		scene.Scatter();
+		Engine::Profiler::SetEnabled(true);
+		Result& result = context.Run("editorui/idle 100 panes profiled (frame)", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				Engine::Profiler::BeginFrame();
+				{
+					ENGINE_PROFILE_SCOPE("Draw");
+					scene.DrawFrame();
+				}
+				Engine::Profiler::EndFrame();
+			}
+		});
+		Engine::Profiler::SetEnabled(false);
+		result.Metric("scopes", (double)Engine::Profiler::GetLastFrame().size());
+	}
+
+	// Drags one pane around, rebuilding the hit grid every frame as main.cpp does while the layout changes
+	static void RunDrag(Context& context, size_t frames)
+	{
+		UIScene scene(100);
+		scene.Scatter();
+		HitGrid hitGrid;
+		Pane& dragged = *scene.panes[42];
+		PaneInteractFlags flags = PaneInteractFlags::focused | PaneInteractFlags::beingDragged;
+		size_t hits = 0;
+
+		Result& result = context.Run("editorui/drag 100 panes (frame)", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				float step = (i / 200) % 2 ? -2.0f : 2.0f;
+				dragged.Move({ step, step * 0.5f });
+
+				hitGrid.Clear();
+				for (size_t p = 0; p < scene.panes.size(); ++p)
+				{
+					hitGrid.AddPane(*scene.panes[p], (int)p);
+				}
+				hits += (bool)hitGrid.HitTest({ dragged.rect.x + 5, dragged.rect.y + 5 });
+
+				scene.DrawFrame(&dragged, flags);
+			}
+		});
+		DoNotOptimize(hits);
+		AddFrameMetrics(result, scene.sink.GetFrameStats());
+	}
+
+	// Docks all but one pane, then drags the last across the layout looking for snap targets
+	static void RunDockDrag(Context& context, size_t frames)
+	{
+		UIScene scene(101);
+		DockTree dockTree;
+		dockTree.SetArea({ 0, 0, screenWidth, screenHeight });
+
+		// Before anything is docked only the window's edges are targets; a drag anywhere else leaves the pane floating
+		size_t emptyTreeTargets = 0;
+		for (float y = SnapRect::snapSize; y < screenHeight - SnapRect::snapSize; y += 16)
+		{
+			for (float x = SnapRect::snapSize; x < screenWidth - SnapRect::snapSize; x += 16)
+			{
+				emptyTreeTargets += (bool)dockTree.FindTarget({ x, y });
+			}
+		}
+
+		// Each pane splits an earlier one, alternating between its right and bottom edge
+		size_t docked = 0;
+		for (size_t i = 0; i + 1 < scene.panes.size(); ++i)
+		{
+			rl::Vector2 point = { 1, 1 };
+			if (i > 0)
+			{
+				const rl::Rectangle& rect = scene.panes[i / 2]->rect;
+				point = i % 2
+					? rl::Vector2{ rect.x + rect.width - 2, rect.y + rect.height / 2 }
+					: rl::Vector2{ rect.x + rect.width / 2, rect.y + rect.height - 2 };
+			}
+			DockTree::Target target = dockTree.FindTarget(point);
+			if (!target) continue;
+			dockTree.Dock(*scene.panes[i], target);
+			++docked;
+		}
+
+		Pane& dragged = *scene.panes.back();
+		dragged.SetRect({ 0, 0, 120, 80 });
+		PaneInteractFlags flags = PaneInteractFlags::focused | PaneInteractFlags::beingDragged;
+		size_t targets = 0;
+
+		Result& result = context.Run("editorui/dock drag 100 panes (frame)", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				rl::Vector2 cursor = { (float)(i * 7 % (size_t)screenWidth), (float)(i * 3 % (size_t)screenHeight) };
+				dragged.SetRect({ cursor.x - 10, cursor.y - 10, 120, 80 });
+
+				DockTree::Target target = dockTree.FindTarget(cursor);
+				targets += (bool)target;
+
+				scene.sink.BeginFrame();
+				for (const std::unique_ptr<Pane>& pane : scene.panes)
+				{
+					if (pane.get() == &dragged) pane->DrawFocused(scene.drawList, flags);
+					else pane->Draw(scene.drawList);
+				}
+				if (target) scene.drawList.DrawRectangle(dockTree.GetTargetRect(target), Theme::color_highlight);
+				scene.drawList.Submit();
+				textCache.EvictUnused(textCacheMaxAge);
+			}
+		});
+		DoNotOptimize(targets);
+		AddFrameMetrics(result, scene.sink.GetFrameStats());
+		result.Metric("docked", (double)docked);
+		result.Metric("emptyTreeTargets", (double)emptyTreeTargets); // Should be 0
+	}
+
+	// Drags the split between two docked panes back and forth
+	static void RunSplitResize(Context& context, size_t frames)
+	{
+		UIScene scene(100);
+		DockTree dockTree;
+		dockTree.SetArea({ 0, 0, screenWidth, screenHeight });
+		for (size_t i = 0; i < scene.panes.size(); ++i)
+		{
+			const rl::Rectangle& rect = i ? scene.panes[i - 1]->rect : rl::Rectangle{ 0, 0, screenWidth, screenHeight };
+			DockTree::Target target = dockTree.FindTarget({ rect.x + rect.width - 2, rect.y + rect.height / 2 });
+			if (i % 2 == 0 && i > 0) target = dockTree.FindTarget({ rect.x + rect.width / 2, rect.y + rect.height - 2 });
+			if (target) dockTree.Dock(*scene.panes[i], target);
+		}
+
+		Pane& resized = *scene.panes[0];
+		size_t laidOut = 0;
+		Result& result = context.Run("editorui/split resize 100 panes (frame)", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				dockTree.Resize(resized, { (i / 50) % 2 ? -1.0f : 1.0f, 0 });
+				laidOut += dockTree.GetLastLayoutCount();
+				scene.DrawFrame(&resized, PaneInteractFlags::focused | PaneInteractFlags::resizingX);
+			}
+		});
+		AddFrameMetrics(result, scene.sink.GetFrameStats());
+		result.Metric("nodesLaidOut", (double)laidOut / (double)std::max<size_t>(frames, 1));
+	}
+
+	// Jumps around a 100k node hierarchy; only the rows on screen should cost anything, and only recent ones stay in the text cache
+	static void RunTreeScroll(Context& context, size_t frames)
+	{
+		UIScene scene(1);
+		TreeView tree;
+		for (size_t group = 0; group < 1000; ++group)
+		{
+			TreeView::NodeId parent = tree.AddNode("Group " + std::to_string(group));
+			tree.SetExpanded(parent, true);
+			for (size_t child = 0; child < 100; ++child)
+			{
+				tree.AddNode("Object " + std::to_string(group * 100 + child), parent);
+			}
+		}
+		Pane& pane = *scene.panes[0];
+		pane.SetRect({ 0, 0, 300, screenHeight });
+		pane.content = &tree;
+
+		Result& result = context.Run("editorui/tree scroll 100k nodes (frame)", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				tree.ScrollToRow(i * 997 % tree.GetRowCount());
+				scene.DrawFrame();
+			}
+		});
+		AddFrameMetrics(result, scene.sink.GetFrameStats());
+		result.Metric("rowsDrawn", (double)tree.GetLastDrawnRowCount());
+		result.Metric("textRuns", (double)textCache.GetCount());
+	}
+
+	// The idle frame rasterized, with a checksum of the image for spotting rendering changes
+	static void RunRaster(Context& context, size_t frames)
+	{
+		UIScene scene(100);
+		scene.Scatter();
+		scene.sink.SetTarget((int)screenWidth, (int)screenHeight);
+		rl::Image uiImage = GenUITextureImage();
+		scene.sink.SetTexturePixels(uiTexture, (const rl::Color*)uiImage.data);
+		rl::UnloadImage(uiImage);
+
+		Result& result = context.Run("editorui/raster 1280x720 (frame)", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				scene.sink.ClearTarget(Theme::color_main);
+				scene.DrawFrame();
+			}
+		}, 3);
+
+		// FNV-1a, truncated so it survives being stored as a double
+		uint32_t hash = 2166136261u;
+		for (const rl::Color& pixel : scene.sink.GetPixels())
+		{
+			for (unsigned char channel : { pixel.r, pixel.g, pixel.b, pixel.a })
+			{
+				hash = (hash ^ channel) * 16777619u;
+			}
+		}
+		AddFrameMetrics(result, scene.sink.GetFrameStats());
+		result.Metric("checksum", (double)hash);
+	}
+
+	void RunEditorUI(Context& context)
+	{
+		size_t frames = context.Scale(2000);
+		RunIdle(context, frames);
+		RunProfiledIdle(context, frames);
+		RunDrag(context, frames);
+		RunDockDrag(context, frames);
+		RunSplitResize(context, frames);
+		RunTreeScroll(context, frames);
+		RunRaster(context, context.Scale(100));
+	}
+}
@@ -0,0 +1,81 @@
+// JobSystem scaling from one thread up to every hardware thread
+#include <cmath>
+#include <memory>
+#include <thread>
+#include "Bench.h"
+#include "Engine.Jobs.h"
+
+using namespace Engine;
+
+namespace Bench
+{
+	namespace
+	{
+		class Spinner : public Behavior
+		{
+		private:
+			float angle = 0;
+
+		public:
+			void Update() override
+			{
+				for (int i = 0; i < 16; ++i)
+				{
+					angle = std::fmod(angle + std::sqrt(angle + 1.0f), 360.0f);
+				}
+			}
+			bool IsThreadSafe() const override { return true; }
+		};
+	}
+
+	void RunJobs(Context& context)
+	{
+		const size_t count = context.Scale(1 << 22);
+		std::vector<float> values(count, 1.0f);
+
+		std::vector<std::unique_ptr<Spinner>> spinners(context.Scale(100000));
+		std::vector<Behavior*> behaviors;
+		for (std::unique_ptr<Spinner>& spinner : spinners)
+		{
+			spinner = std::make_unique<Spinner>();
+			behaviors.push_back(spinner.get());
+		}
+
+		// 1, 2, 4... threads, always ending on every hardware thread
+		size_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		std::vector<size_t> threadCounts;
+		for (size_t threads = 1; threads < maxThreads; threads *= 2)
+		{
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+
+		double singleThreadParallelFor = 0, singleThreadBehaviors = 0;
+		for (size_t threads : threadCounts)
+		{
+			JobSystem jobs(threads - 1);
+			string suffix = std::to_string(threads) + "T";
+
+			Result& parallelFor = context.Run("jobs/ParallelFor sqrt " + suffix, count, [&]
+			{
+				JobHandle done = jobs.ParallelFor(count, 16384, [&values](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						values[i] = std::sqrt(values[i] + (float)i);
+					}
+				});
+				jobs.Wait(done);
+			});
+			if (threads == 1) singleThreadParallelFor = parallelFor.nsPerOp;
+			parallelFor.Metric("threads", (double)threads).Metric("speedup", singleThreadParallelFor / parallelFor.nsPerOp);
+
+			Result& update = context.Run("jobs/UpdateBehaviors " + suffix, behaviors.size(), [&]
+			{
+				UpdateBehaviors(behaviors, jobs, 256);
+			});
+			if (threads == 1) singleThreadBehaviors = update.nsPerOp;
+			update.Metric("threads", (double)threads).Metric("speedup", singleThreadBehaviors / update.nsPerOp);
+		}
+	}
+}
@@ -0,0 +1,69 @@
+// What a log call costs its caller, now that formatting and writing happen on the logging thread
+#include <cstdio>
+#include <string>
+#include "Bench.h"
+#include "Debug.Log.h"
+
+using namespace Debug;
+
+namespace Bench
+{
+	void RunLog(Context& context)
+	{
+		std::FILE* output = std::tmpfile();
+		if (!output) return;
+		SetLogOutput(output);
+		size_t count = context.Scale(200000);
+
+		// Flushed every so often so the queue never fills and drops, which would be cheaper than a real log
+		context.Run("log/2 args, with flush", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				LogAt(LogLevel::log, "Frame {} took {} ms", i, 16.6);
+				if ((i & 1023) == 1023) LogFlush();
+			}
+			LogFlush();
+		});
+
+		std::string name = "Hierarchy";
+		context.Run("log/string arg, with flush", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				LogAt(LogLevel::warning, "Pane {} is off screen", name);
+				if ((i & 1023) == 1023) LogFlush();
+			}
+			LogFlush();
+		});
+
+		SetLogLevel(LogLevel::error);
+		context.Run("log/filtered out", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				LogAt(LogLevel::log, "Frame {} took {} ms", i, 16.6);
+			}
+		});
+
+		// Building the message first, as Debug::Log(object.ToString()) does, is wasted when it is filtered out
+		context.Run("log/filtered out, message built first", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				LogAt(LogLevel::log, "Frame " + std::to_string(i) + " of " + name);
+			}
+		});
+		context.Run("log/filtered out, DEBUG_LOG", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				DEBUG_LOG("Frame {} of {}", std::to_string(i), name);
+			}
+		});
+		SetLogLevel(LogLevel::log);
+
+		SetLogOutput(stdout);
+		std::fclose(output);
+	}
+}
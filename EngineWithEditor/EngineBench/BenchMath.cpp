@@ -0,0 +1,123 @@
+// Vector/matrix math and PositionCollection iteration orders
+#include <random>
+#include "Bench.h"
+#include "Engine.Core.h"
+
+using namespace Engine;
+
+namespace Bench
+{
+	static void RunVectorMath(Context& context)
+	{
+		const size_t count = context.Scale(1000000);
+
+		context.Run("math/Vector2 MoveTowards", count, [&]
+		{
+			Vector2 position = Vector2::zero;
+			Vector2 target(1000, -500);
+			for (size_t i = 0; i < count; ++i)
+			{
+				position = Vector2::MoveTowards(position, target, 0.001f);
+			}
+			DoNotOptimize(position);
+		});
+		context.Run("math/Matrix3x2 TRS*TRS", count, [&]
+		{
+			Matrix3x2 accumulated = Matrix3x2::identity;
+			for (size_t i = 0; i < count; ++i)
+			{
+				Matrix3x2 local = Matrix3x2::TRS(Vector2((float)(i & 15), 1), 0.001f, Vector2::one);
+				accumulated = accumulated * local;
+			}
+			DoNotOptimize(accumulated);
+		});
+	}
+
+	static void RunBatchTransforms(Context& context)
+	{
+		const size_t count = 4096;
+		const size_t rounds = context.Scale(1000);
+		const Matrix3x2 matrix = Matrix3x2::TRS(Vector2(10, 20), 0.5f, Vector2(2, 3));
+
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> coordinate(-1000, 1000);
+		std::vector<Vector2> points(count);
+		std::vector<Rect> rects(count);
+		std::vector<Rect> bounds(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			points[i] = Vector2(coordinate(random), coordinate(random));
+			rects[i] = Rect(coordinate(random), coordinate(random), 50, 20);
+		}
+
+		context.Run("math/MultiplyPoint x4096", rounds * count, [&]
+		{
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				for (Vector2& point : points)
+				{
+					point = matrix.MultiplyPoint(point);
+				}
+				DoNotOptimize(points.front());
+			}
+		});
+		context.Run("math/TransformPoints x4096", rounds * count, [&]
+		{
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				TransformPoints(matrix, points);
+				DoNotOptimize(points.front());
+			}
+		}).Metric("simd", ENGINE_SSE2);
+		context.Run("math/MultiplyRect x4096", rounds * count, [&]
+		{
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					bounds[i] = matrix.MultiplyRect(rects[i]);
+				}
+				DoNotOptimize(bounds.front());
+			}
+		});
+		context.Run("math/TransformRectsToAABB x4096", rounds * count, [&]
+		{
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				TransformRectsToAABB(matrix, rects, bounds);
+				DoNotOptimize(bounds.front());
+			}
+		}).Metric("simd", ENGINE_SSE2);
+	}
+
+	// Transposes a grid, which reads and writes in crossing directions
+	static void RunIterationOrders(Context& context)
+	{
+		const int side = context.IsQuick() ? 512 : 2048;
+		const size_t cells = (size_t)side * side;
+		std::vector<float> source(cells, 1.0f);
+		std::vector<float> transposed(cells);
+		PositionCollection positions = RectInt(0, 0, side, side).GetAllPositionsWithin();
+
+		auto transpose = [&](PositionCollection::Order order)
+		{
+			positions.ForEach(order, [&](Vector2Int position)
+			{
+				size_t x = (size_t)position.GetX(), y = (size_t)position.GetY();
+				transposed[x * side + y] = source[y * side + x];
+			});
+			DoNotOptimize(transposed.front());
+		};
+
+		context.Run("positions/transpose rowMajor", cells, [&] { transpose(PositionCollection::Order::rowMajor); });
+		context.Run("positions/transpose tiled", cells, [&] { transpose(PositionCollection::Order::tiled); });
+		context.Run("positions/transpose morton", cells, [&] { transpose(PositionCollection::Order::morton); });
+	}
+
+	void RunMath(Context& context)
+	{
+		RunVectorMath(context);
+		RunBatchTransforms(context);
+		RunIterationOrders(context);
+	}
+}
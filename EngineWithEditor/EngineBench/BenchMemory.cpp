@@ -0,0 +1,74 @@
+// hw::Memory allocator and the hw:: containers, against the standard library
+#include "Bench.h"
+#include "containers.h"
+
+namespace Bench
+{
+	void RunMemory(Context& context)
+	{
+		const size_t rounds = context.Scale(100000);
+		constexpr size_t blockCount = 8;
+		constexpr size_t blockSize = 64;
+
+		// Allocate a handful of blocks, then free them newest first
+		context.Run("memory/hw::Alloc+Dealloc 64B", rounds * blockCount, [&]
+		{
+			byte* blocks[blockCount];
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				for (size_t i = 0; i < blockCount; ++i)
+				{
+					blocks[i] = hw::Alloc<byte>(blockSize);
+					DoNotOptimize(blocks[i]);
+				}
+				for (size_t i = blockCount; i-- > 0;)
+				{
+					hw::Dealloc(blocks[i], blockSize);
+				}
+			}
+		});
+		context.Run("memory/new+delete 64B", rounds * blockCount, [&]
+		{
+			byte* blocks[blockCount];
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				for (size_t i = 0; i < blockCount; ++i)
+				{
+					blocks[i] = new byte[blockSize];
+					DoNotOptimize(blocks[i]);
+				}
+				for (size_t i = blockCount; i-- > 0;)
+				{
+					delete[] blocks[i];
+				}
+			}
+		});
+
+		// Small enough for every reallocation to fit in hw::Memory's pool
+		constexpr int elementCount = 64;
+		context.Run("containers/hw::vector push_back 64 ints", rounds * elementCount, [&]
+		{
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				hw::vector<int> values;
+				for (int i = 0; i < elementCount; ++i)
+				{
+					values.push_back(i);
+				}
+				DoNotOptimize(values.back());
+			}
+		});
+		context.Run("containers/std::vector push_back 64 ints", rounds * elementCount, [&]
+		{
+			for (size_t round = 0; round < rounds; ++round)
+			{
+				std::vector<int> values;
+				for (int i = 0; i < elementCount; ++i)
+				{
+					values.push_back(i);
+				}
+				DoNotOptimize(values.back());
+			}
+		});
+	}
+}
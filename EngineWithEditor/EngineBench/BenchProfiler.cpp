@@ -0,0 +1,83 @@
+// Cost of Engine::Profiler scopes, which have to stay cheap enough to leave on in hot paths
+#include <cstdint>
+#include "Bench.h"
+#include "Engine.Profiler.h"
+
+using namespace Engine;
+
+namespace Bench
+{
+	// A little work for a scope to time, so the loop isn't only the scope
+	static uint64_t Work(uint64_t value)
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			value = value * 6364136223846793005ull + 1442695040888963407ull;
+		}
+		return value;
+	}
+
+	static void RunScopes(Context& context, size_t count, bool enabled)
+	{
+		Profiler::SetEnabled(enabled);
+		uint64_t value = 1;
+		context.Run(enabled ? "profiler/scope enabled" : "profiler/scope disabled", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				ENGINE_PROFILE_SCOPE("Bench scope");
+				value = Work(value);
+				// Keep the ring from filling with a whole run's scopes, as one frame's never would
+				if ((i & 1023) == 1023) Profiler::EndFrame();
+			}
+			Profiler::EndFrame();
+		});
+		DoNotOptimize(value);
+		Profiler::SetEnabled(false);
+	}
+
+	static void RunBaseline(Context& context, size_t count)
+	{
+		uint64_t value = 1;
+		context.Run("profiler/no scope", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				value = Work(value);
+			}
+		});
+		DoNotOptimize(value);
+	}
+
+	// Summing a frame of nested scopes, as the editor does once per frame
+	static void RunEndFrame(Context& context, size_t frames)
+	{
+		Profiler::SetEnabled(true);
+		Result& result = context.Run("profiler/end frame 256 scopes", frames, [&]
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				for (int outer = 0; outer < 32; ++outer)
+				{
+					ENGINE_PROFILE_SCOPE("Bench outer");
+					for (int inner = 0; inner < 7; ++inner)
+					{
+						ENGINE_PROFILE_SCOPE("Bench inner");
+					}
+				}
+				Profiler::EndFrame();
+			}
+		});
+		result.Metric("scopeNames", (double)Profiler::GetLastFrame().size());
+		Profiler::SetEnabled(false);
+	}
+
+	void RunProfiler(Context& context)
+	{
+		size_t count = context.Scale(2000000);
+		RunBaseline(context, count);
+		RunScopes(context, count, false);
+		RunScopes(context, count, true);
+		RunEndFrame(context, context.Scale(10000));
+	}
+}
@@ -0,0 +1,173 @@
+// Binary (mapped) scene loading against the text format, and AssetCache lookups
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include "Bench.h"
+#include "Engine.Assets.h"
+#include "Engine.Scene.h"
+
+using namespace Engine;
+
+namespace Bench
+{
+	static void DestroyAll(std::vector<Object*>& objects)
+	{
+		for (Object* object : objects)
+		{
+			Object::Destroy(object);
+		}
+		objects.clear();
+	}
+
+	static void RunSceneLoad(Context& context)
+	{
+		const size_t count = context.Scale(1000000);
+		std::vector<Object*> source;
+		source.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			Object* object = new Object();
+			object->SetName("Object " + std::to_string(i));
+			object->SetHideFlags((i % 7 == 0) ? HideFlags::HideInHierarchy : HideFlags::None);
+			source.push_back(object);
+		}
+
+		std::filesystem::path directory = std::filesystem::temp_directory_path();
+		string binaryPath = (directory / "engine_bench_scene.bin").string();
+		string textPath = (directory / "engine_bench_scene.txt").string();
+		std::span<const Object* const> objects(source.data(), source.size());
+		if (!SaveScene(binaryPath.c_str(), objects, SceneTarget::build) ||
+			!SaveSceneText(textPath.c_str(), objects, SceneTarget::build))
+		{
+			std::fprintf(stderr, "Couldn't write scenes to %s\n", directory.string().c_str());
+			DestroyAll(source);
+			return;
+		}
+		DestroyAll(source);
+
+		size_t nameBytes = 0;
+		context.Run("scene/binary open", count, [&]
+		{
+			MappedScene scene;
+			scene.Open(binaryPath.c_str());
+			nameBytes = 0;
+			for (const SceneObjectRecord& record : scene.GetObjects())
+			{
+				nameBytes += record.GetName().size();
+			}
+			DoNotOptimize(nameBytes);
+		}, 3).Metric("fileBytes", (double)std::filesystem::file_size(binaryPath));
+
+		std::vector<Object*> loaded;
+		context.Run("scene/binary open+instantiate", count, [&]
+		{
+			MappedScene scene;
+			scene.Open(binaryPath.c_str());
+			scene.Instantiate(loaded);
+			DestroyAll(loaded);
+		}, 3);
+		context.Run("scene/text load", count, [&]
+		{
+			LoadSceneText(textPath.c_str(), loaded);
+			DestroyAll(loaded);
+		}, 3).Metric("fileBytes", (double)std::filesystem::file_size(textPath));
+
+		std::filesystem::remove(binaryPath);
+		std::filesystem::remove(textPath);
+	}
+
+	static void RunAssetCache(Context& context)
+	{
+		constexpr int assetCount = 256;
+		const size_t lookups = context.Scale(1000000);
+		AssetCache<int> cache([](strcref path) { return (int)path.size(); }, [](int&) {});
+
+		std::vector<string> paths;
+		for (int i = 0; i < assetCount; ++i)
+		{
+			paths.push_back("resources/textures/asset" + std::to_string(i) + ".png");
+		}
+		std::vector<AssetCache<int>::Handle> held;
+		for (strcref path : paths)
+		{
+			held.push_back(cache.Load(path));
+		}
+
+		context.Run("assets/Load cached", lookups, [&]
+		{
+			for (size_t i = 0; i < lookups; ++i)
+			{
+				AssetCache<int>::Handle handle = cache.Load(paths[i % assetCount]);
+				DoNotOptimize(handle.Get());
+			}
+		});
+	}
+
+	// Several threads stream in the same assets at once, then drop them. Each asset should be loaded
+	// once (loaderCalls 256), and the sweep should unload all but the quarter flagged
+	// DontUnloadUnusedAsset (unloaded 192, kept 64).
+	static void RunAssetStreaming(Context& context)
+	{
+		constexpr int assetCount = 256;
+		constexpr int threadCount = 4;
+		std::vector<string> paths;
+		for (int i = 0; i < assetCount; ++i)
+		{
+			paths.push_back("resources/sounds/asset" + std::to_string(i) + ".wav");
+		}
+		auto flagsFor = [](int i) { return i % 4 == 0 ? HideFlags::DontUnloadUnusedAsset : HideFlags::None; };
+
+		// Only touches atomics, so it can run on the worker thread
+		std::atomic<size_t> loaderCalls = 0;
+		auto loader = [&loaderCalls](strcref path)
+		{
+			loaderCalls.fetch_add(1, std::memory_order_relaxed);
+			return (int)(HashAssetPath(path) & 0xffff);
+		};
+
+		size_t unloaded = 0, kept = 0;
+		std::atomic<uint64_t> checksum = 0;
+		context.Run("assets/LoadAsync shared by 4 threads", (size_t)assetCount * threadCount, [&]
+		{
+			loaderCalls = 0;
+			AssetCache<int> cache(loader, [](int&) {});
+			std::vector<std::thread> threads;
+			for (int t = 0; t < threadCount; ++t)
+			{
+				threads.emplace_back([&]
+				{
+					std::vector<AssetCache<int>::Handle> handles;
+					for (int i = 0; i < assetCount; ++i)
+					{
+						handles.push_back(cache.LoadAsync(paths[i], flagsFor(i)));
+					}
+					// Most of these are still queued, so Get has to wait for the worker
+					uint64_t sum = 0;
+					for (const AssetCache<int>::Handle& handle : handles)
+					{
+						sum += handle.Get();
+					}
+					checksum.fetch_add(sum, std::memory_order_relaxed);
+				});
+			}
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+			unloaded = cache.UnloadUnusedAssets();
+			kept = cache.GetCount();
+		})
+			.Metric("loaderCalls", (double)loaderCalls)
+			.Metric("unloaded", (double)unloaded)
+			.Metric("kept", (double)kept);
+		DoNotOptimize(checksum.load());
+	}
+
+	void RunScene(Context& context)
+	{
+		RunSceneLoad(context);
+		RunAssetCache(context);
+		RunAssetStreaming(context);
+	}
+}
@@ -0,0 +1,130 @@
+// RectTree broad-phase and DirtyRegionSet repaint coverage
+#include <random>
+#include "Bench.h"
+#include "Engine.DirtyRegion.h"
+#include "Engine.Spatial.h"
+
+using namespace Engine;
+
+namespace Bench
+{
+	static void RunRectTree(Context& context)
+	{
+		const size_t count = context.Scale(100000);
+		const size_t frames = 10;
+		const size_t queriesPerFrame = 1000;
+		constexpr float worldSize = 8192;
+		constexpr float querySize = 128;
+
+		std::mt19937 random(2);
+		std::uniform_real_distribution<float> coordinate(0, worldSize);
+		std::uniform_real_distribution<float> extent(8, 32);
+		std::uniform_real_distribution<float> speed(-2, 2);
+
+		std::vector<Rect> rects(count);
+		std::vector<Vector2> velocities(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			rects[i] = Rect(coordinate(random), coordinate(random), extent(random), extent(random));
+			velocities[i] = Vector2(speed(random), speed(random));
+		}
+		std::vector<Vector2> queryPoints(queriesPerFrame);
+		for (Vector2& point : queryPoints)
+		{
+			point = Vector2(coordinate(random), coordinate(random));
+		}
+
+		RectTree tree;
+		std::vector<int> proxies(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			proxies[i] = tree.Insert(rects[i]);
+		}
+
+		std::vector<int> found(count);
+		size_t reinserted = 0;
+		size_t hits = 0;
+		context.Run("spatial/RectTree move+query frame", frames, [&]
+		{
+			reinserted = 0;
+			hits = 0;
+			for (size_t frame = 0; frame < frames; ++frame)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					rects[i].SetPosition(rects[i].GetPosition() + velocities[i]);
+					reinserted += tree.Move(proxies[i], rects[i], velocities[i]);
+				}
+				for (Vector2 point : queryPoints)
+				{
+					hits += tree.Query(Rect(point.GetX(), point.GetY(), querySize, querySize), found.data(), found.size());
+				}
+			}
+		}, 1)
+			.Metric("rects", (double)count)
+			.Metric("reinsertedPerFrame", (double)reinserted / frames)
+			.Metric("hitsPerFrame", (double)hits / frames)
+			.Metric("treeHeight", tree.GetHeight());
+
+		// What every query cost before: testing against every rect
+		context.Run("spatial/brute force query frame", 1, [&]
+		{
+			hits = 0;
+			for (Vector2 point : queryPoints)
+			{
+				Rect area(point.GetX(), point.GetY(), querySize, querySize);
+				for (const Rect& rect : rects)
+				{
+					hits += area.Overlaps(rect);
+				}
+			}
+			DoNotOptimize(hits);
+		}, 1).Metric("rects", (double)count);
+	}
+
+	// Random widgets repainting on a 1080p view, a few of them clustered together each frame
+	static void RunDirtyRegions(Context& context, size_t maxRects)
+	{
+		const size_t frames = context.Scale(10000);
+		constexpr int width = 1920, height = 1080;
+		constexpr int invalidationsPerFrame = 24;
+
+		std::mt19937 random(3);
+		std::uniform_int_distribution<int> x(0, width), y(0, height);
+		std::uniform_int_distribution<int> size(8, 160);
+		std::uniform_int_distribution<int> jitter(-40, 40);
+
+		DirtyRegionSet dirty(maxRects);
+		dirty.SetBounds(RectInt(0, 0, width, height));
+		std::vector<RectInt> repaint;
+		long long repaintedArea = 0;
+		size_t repaintedRects = 0;
+
+		context.Run("dirty/" + std::to_string(maxRects) + " rects invalidate+flush frame", frames, [&]
+		{
+			repaintedArea = 0;
+			repaintedRects = 0;
+			for (size_t frame = 0; frame < frames; ++frame)
+			{
+				Vector2Int cluster(x(random), y(random));
+				for (int i = 0; i < invalidationsPerFrame; ++i)
+				{
+					Vector2Int position = (i % 3 == 0) ? Vector2Int(x(random), y(random)) : cluster + Vector2Int(jitter(random), jitter(random));
+					dirty.Invalidate(RectInt(position.GetX(), position.GetY(), size(random), size(random)));
+				}
+				repaintedArea += dirty.GetDirtyArea();
+				dirty.Flush(repaint);
+				repaintedRects += repaint.size();
+			}
+		}, 1)
+			.Metric("repaintedFraction", (double)repaintedArea / ((double)frames * width * height))
+			.Metric("rectsPerFrame", (double)repaintedRects / frames);
+	}
+
+	void RunSpatial(Context& context)
+	{
+		RunRectTree(context);
+		RunDirtyRegions(context, 4);
+		RunDirtyRegions(context, 16);
+	}
+}
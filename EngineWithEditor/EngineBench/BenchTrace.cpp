@@ -0,0 +1,65 @@
+// Cost of Debug trace events while recording, and of writing them out as trace JSON
+#include <cstdio>
+#include <filesystem>
+#include "Bench.h"
+#include "Debug.Trace.h"
+#include "Engine.Jobs.h"
+
+using namespace Engine;
+
+namespace Bench
+{
+	static void RunTraceScopes(Context& context, const std::string& path, size_t count)
+	{
+		context.Run("trace/scope not tracing", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				DEBUG_TRACE_SCOPE("Bench scope");
+			}
+		});
+
+		Debug::TraceStart(path.c_str());
+		context.Run("trace/scope tracing, with flush", count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				DEBUG_TRACE_SCOPE("Bench scope");
+				// As often as a frame would, so no events are dropped
+				if ((i & 1023) == 1023) Debug::TraceFlush();
+			}
+			Debug::TraceFlush();
+		});
+		Debug::TraceStop();
+	}
+
+	// Many threads recording at once, flushed from this one, as with UpdateBehaviors
+	static void RunTraceJobs(Context& context, const std::string& path, size_t batches)
+	{
+		JobSystem jobs;
+		Debug::TraceStart(path.c_str());
+		Result& result = context.Run("trace/parallel batches (batch)", batches, [&]
+		{
+			for (size_t frame = 0; frame < batches / 256; ++frame)
+			{
+				JobHandle done = jobs.ParallelFor(256, 1, [](size_t, size_t)
+				{
+					DEBUG_TRACE_SCOPE("Bench batch");
+					Debug::TraceCounter("Bench counter", 1);
+				});
+				jobs.Wait(done);
+				Debug::TraceFlush();
+			}
+		});
+		Debug::TraceStop();
+		result.Metric("fileBytes", (double)std::filesystem::file_size(path));
+	}
+
+	void RunTrace(Context& context)
+	{
+		std::string path = (std::filesystem::temp_directory_path() / "engine_bench.trace.json").string();
+		RunTraceScopes(context, path, context.Scale(1000000));
+		RunTraceJobs(context, path, context.Scale(256 * 200));
+		std::remove(path.c_str());
+	}
+}
@@ -0,0 +1,94 @@
+// Engine core microbenchmarks.
+// Usage: engine_bench [--quick] [output.json]
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include "Bench.h"
+
+namespace
+{
+	std::string EscapeJson(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	const char* CompilerName()
+	{
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc";
+#else
+		return "unknown";
+#endif
+	}
+
+	bool WriteJson(const char* path, const Bench::Context& context)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file) return false;
+
+		// Enough digits for metrics that are exact integers, such as checksums
+		file << std::setprecision(10);
+		file << "{\n";
+		file << "\t\"compiler\": \"" << EscapeJson(CompilerName()) << "\",\n";
+		file << "\t\"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+		file << "\t\"quick\": " << (context.IsQuick() ? "true" : "false") << ",\n";
+		file << "\t\"results\": [\n";
+		const std::vector<Bench::Result>& results = context.GetResults();
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Bench::Result& result = results[i];
+			file << "\t\t{ \"name\": \"" << EscapeJson(result.name) << "\", \"iterations\": " << result.iterations
+				<< ", \"nsPerOp\": " << result.nsPerOp << ", \"metrics\": {";
+			for (size_t m = 0; m < result.metrics.size(); ++m)
+			{
+				file << (m ? ", " : " ") << '"' << EscapeJson(result.metrics[m].first) << "\": " << result.metrics[m].second;
+			}
+			file << (result.metrics.empty() ? "} }" : " } }") << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		file << "\t]\n}\n";
+		return (bool)file;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = false;
+	const char* outputPath = "engine_bench.json";
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0) quick = true;
+		else outputPath = argv[i];
+	}
+
+	Bench::Context context(quick);
+	Bench::RunMemory(context);
+	Bench::RunMath(context);
+	Bench::RunSpatial(context);
+	Bench::RunJobs(context);
+	Bench::RunScene(context);
+	Bench::RunProfiler(context);
+	Bench::RunTrace(context);
+	Bench::RunLog(context);
+#ifdef ENGINE_BENCH_EDITOR_UI
+	Bench::RunEditorUI(context);
+#endif
+
+	if (!WriteJson(outputPath, context))
+	{
+		std::fprintf(stderr, "Failed to write %s\n", outputPath);
+		return 1;
+	}
+	std::printf("Wrote %zu results to %s\n", context.GetResults().size(), outputPath);
+	return 0;
+}
@@ -0,0 +1,472 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include "Platform.h"
+
+// Log messages below this level are compiled out: 0 log, 1 warning, 2 error, 3 none.
+// Define it the same for the whole program. By default debug builds log everything and release builds nothing.
+#ifndef DEBUG_LOG_LEVEL
+#if _DEBUG
+#define DEBUG_LOG_LEVEL 0
+#else
+#define DEBUG_LOG_LEVEL 3
+#endif
+#endif
+
+namespace Debug
+{
+	enum class LogLevel : uint8_t
+	{
+		log,
+		warning,
+		error,
+		none, // As a minimum level, filters everything out
+	};
+
+	constexpr LogLevel compiledLogLevel = (LogLevel)DEBUG_LOG_LEVEL;
+
+	namespace _Log
+	{
+		enum class ArgumentType : uint8_t
+		{
+			signedInteger,
+			unsignedInteger,
+			floatingPoint,
+			boolean,
+			pointer,
+			text, // Copied into the record's text
+		};
+
+		struct Argument
+		{
+			ArgumentType type;
+			uint16_t textOffset;
+			uint16_t textLength;
+			union
+			{
+				int64_t signedInteger;
+				uint64_t unsignedInteger;
+				double floatingPoint;
+				const void* pointer;
+			};
+		};
+
+		// Outside the Logger, so checking it doesn't start the logging thread
+		inline std::atomic<LogLevel> minimumLevel = LogLevel::log;
+
+		constexpr size_t maxArguments = 6;
+		constexpr size_t textCapacity = 128;
+
+		// One log call, as the caller left it: the format's address and the raw arguments.
+		// Turning that into text is left to the logging thread.
+		struct Record
+		{
+			const char* format; // A string literal, or null if the message is in text
+			LogLevel level;
+			uint8_t argumentCount;
+			uint16_t textSize;
+			bool truncated;
+			Argument arguments[maxArguments];
+			char text[textCapacity];
+
+			void AppendText(std::string_view value, _Out_ uint16_t& offset, _Out_ uint16_t& length)
+			{
+				size_t copied = std::min(value.size(), textCapacity - textSize);
+				truncated |= copied < value.size();
+				std::memcpy(text + textSize, value.data(), copied);
+				offset = textSize;
+				length = (uint16_t)copied;
+				textSize += (uint16_t)copied;
+			}
+
+			template<class _Ty>
+			void Capture(const _Ty& value)
+			{
+				if constexpr (std::is_enum_v<_Ty>)
+				{
+					Capture((std::underlying_type_t<_Ty>)value);
+				}
+				else
+				{
+					Store(arguments[argumentCount++], value);
+				}
+			}
+
+			template<class _Ty>
+			void Store(Argument& argument, const _Ty& value)
+			{
+				if constexpr (std::is_same_v<_Ty, bool>)
+				{
+					argument.type = ArgumentType::boolean;
+					argument.unsignedInteger = value;
+				}
+				else if constexpr (std::is_integral_v<_Ty> && std::is_signed_v<_Ty>)
+				{
+					argument.type = ArgumentType::signedInteger;
+					argument.signedInteger = value;
+				}
+				else if constexpr (std::is_integral_v<_Ty>)
+				{
+					argument.type = ArgumentType::unsignedInteger;
+					argument.unsignedInteger = value;
+				}
+				else if constexpr (std::is_floating_point_v<_Ty>)
+				{
+					argument.type = ArgumentType::floatingPoint;
+					argument.floatingPoint = value;
+				}
+				else if constexpr (std::is_convertible_v<const _Ty&, std::string_view>)
+				{
+					// Strings are copied, since the caller's may be gone by the time the record is formatted
+					argument.type = ArgumentType::text;
+					AppendText(std::string_view(value), argument.textOffset, argument.textLength);
+				}
+				else if constexpr (std::is_pointer_v<_Ty>)
+				{
+					argument.type = ArgumentType::pointer;
+					argument.pointer = value;
+				}
+				else
+				{
+					static_assert(std::is_pointer_v<_Ty>, "Log arguments must be numbers, strings or pointers");
+				}
+			}
+		};
+
+		/*************************************************************
+		* Bounded queue of records that any thread can push to and
+		* the logging thread pops from, without locks.
+		*
+		* Each slot has a sequence number saying whose turn it is:
+		* a pusher claims the next position with a compare-exchange,
+		* fills the slot, then publishes it by bumping its sequence.
+		* When the queue is full the record is dropped and counted
+		* rather than making the caller wait.
+		*************************************************************/
+		class RecordQueue
+		{
+		private:
+			struct Slot
+			{
+				std::atomic<uint64_t> sequence;
+				Record record;
+			};
+
+			static constexpr size_t capacity = 4096; // Must be a power of two
+			std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(capacity);
+			alignas(64) std::atomic<uint64_t> pushPosition = 0;
+			alignas(64) uint64_t popPosition = 0; // Only the logging thread touches it
+
+		public:
+			RecordQueue()
+			{
+				for (size_t i = 0; i < capacity; ++i)
+				{
+					slots[i].sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			// Claims a slot to fill, or returns null if the queue is full. Finish with Publish.
+			_Ret_maybenull_ Record* Claim(_Out_ uint64_t& position)
+			{
+				position = pushPosition.load(std::memory_order_relaxed);
+				for (;;)
+				{
+					Slot& slot = slots[position & (capacity - 1)];
+					uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+					if (sequence == position)
+					{
+						if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) return &slot.record;
+					}
+					else if (sequence < position)
+					{
+						return nullptr; // Full: the slot still holds a record from a lap ago
+					}
+					else
+					{
+						position = pushPosition.load(std::memory_order_relaxed);
+					}
+				}
+			}
+			void Publish(uint64_t position)
+			{
+				slots[position & (capacity - 1)].sequence.store(position + 1, std::memory_order_release);
+			}
+
+			// The oldest published record, or null. Finish with Release. Logging thread only.
+			_Ret_maybenull_ const Record* Peek() const
+			{
+				const Slot& slot = slots[popPosition & (capacity - 1)];
+				return slot.sequence.load(std::memory_order_acquire) == popPosition + 1 ? &slot.record : nullptr;
+			}
+			void Release()
+			{
+				slots[popPosition & (capacity - 1)].sequence.store(popPosition + capacity, std::memory_order_release);
+				++popPosition;
+			}
+		};
+
+		// Formats record as a line: the level, then the format with each {} replaced by the next argument
+		inline void Format(const Record& record, std::string& line)
+		{
+			switch (record.level)
+			{
+			case LogLevel::log: line += "Log | "; break;
+			case LogLevel::warning: line += "Warning | "; break;
+			default: line += "Error | "; break;
+			}
+
+			if (!record.format)
+			{
+				line.append(record.text, record.textSize);
+			}
+			else
+			{
+				size_t next = 0;
+				for (const char* c = record.format; *c; ++c)
+				{
+					if ((c[0] == '{' && c[1] == '{') || (c[0] == '}' && c[1] == '}'))
+					{
+						line += *c++;
+						continue;
+					}
+					if (c[0] != '{' || c[1] != '}' || next == record.argumentCount)
+					{
+						line += *c;
+						continue;
+					}
+					++c;
+
+					const Argument& argument = record.arguments[next++];
+					char buffer[32];
+					std::to_chars_result result = { buffer, {} };
+					switch (argument.type)
+					{
+					case ArgumentType::signedInteger: result = std::to_chars(buffer, buffer + sizeof(buffer), argument.signedInteger); break;
+					case ArgumentType::unsignedInteger: result = std::to_chars(buffer, buffer + sizeof(buffer), argument.unsignedInteger); break;
+					case ArgumentType::floatingPoint: result = std::to_chars(buffer, buffer + sizeof(buffer), argument.floatingPoint); break;
+					case ArgumentType::boolean: line += argument.unsignedInteger ? "true" : "false"; break;
+					case ArgumentType::pointer: result.ptr = buffer + std::snprintf(buffer, sizeof(buffer), "%p", argument.pointer); break;
+					case ArgumentType::text: line.append(record.text + argument.textOffset, argument.textLength); break;
+					}
+					line.append(buffer, result.ptr);
+				}
+			}
+
+			if (record.truncated) line += "...";
+			line += '\n';
+		}
+
+		/*************************************************************
+		* Owns the queue and the thread that empties it. Callers pay
+		* for copying their arguments into a record and a couple of
+		* atomic operations; formatting and writing happen on the
+		* logging thread. It sleeps while the queue is empty, and the
+		* first record pushed after that wakes it.
+		*************************************************************/
+		class Logger
+		{
+		private:
+			RecordQueue queue;
+			std::atomic<uint64_t> dropped = 0;
+			std::atomic<uint64_t> pushed = 0;
+			std::atomic<uint64_t> written = 0;
+			std::atomic<bool> stopping = false;
+			std::atomic<bool> idle = false; // The logging thread is going to sleep, or asleep
+			std::mutex wakeLock;
+			std::condition_variable wake;
+			std::mutex outputLock; // Held while formatting and writing, so Flush can drain from any thread
+			std::FILE* output = stdout;
+			std::string line;
+			std::thread thread;
+
+			// Writes out everything queued so far. Call with outputLock held.
+			void Drain()
+			{
+				line.clear();
+				size_t count = 0;
+				for (const Record* record = queue.Peek(); record; record = queue.Peek())
+				{
+					Format(*record, line);
+					queue.Release();
+					++count;
+				}
+				uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+				if (lost) line += "Warning | " + std::to_string(lost) + " log messages were dropped\n";
+				if (line.empty()) return;
+				std::fwrite(line.data(), 1, line.size(), output);
+				std::fflush(output);
+				written.fetch_add(count, std::memory_order_release);
+			}
+
+			void ThreadMain()
+			{
+				while (!stopping.load(std::memory_order_acquire))
+				{
+					// Everything counted in seen has been published, so Drain writes it all unless an earlier record is
+					// still being filled in, and that one changes pushed when it is
+					uint64_t seen = pushed.load(std::memory_order_acquire);
+					{
+						std::lock_guard<std::mutex> guard(outputLock);
+						Drain();
+					}
+
+					std::unique_lock<std::mutex> guard(wakeLock);
+					idle.store(true);
+					// The timeout is only a backstop, e.g. for reporting messages dropped while nothing was published
+					wake.wait_for(guard, std::chrono::milliseconds(100), [&]
+					{
+						return pushed.load() != seen || stopping.load(std::memory_order_acquire);
+					});
+					idle.store(false, std::memory_order_relaxed);
+				}
+				std::lock_guard<std::mutex> guard(outputLock);
+				Drain();
+			}
+
+			// Called after pushed changes. Only the first push since the logging thread went idle pays for waking it.
+			void Wake()
+			{
+				if (!idle.load() || !idle.exchange(false)) return;
+				std::lock_guard<std::mutex> guard(wakeLock);
+				wake.notify_one();
+			}
+
+		public:
+			Logger() : thread([this] { ThreadMain(); }) {}
+			~Logger()
+			{
+				stopping.store(true, std::memory_order_release);
+				{
+					std::lock_guard<std::mutex> guard(wakeLock);
+					wake.notify_one();
+				}
+				thread.join();
+			}
+
+			// Messages lost to a full queue since the logging thread last reported them
+			uint64_t GetDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+			// Writes to output from now on; stdout by default. output must stay open while the logger uses it.
+			void SetOutput(_In_ std::FILE* newOutput)
+			{
+				std::lock_guard<std::mutex> guard(outputLock);
+				Drain();
+				output = newOutput;
+			}
+
+			// Formats and writes everything logged before the call, on the calling thread
+			void Flush()
+			{
+				uint64_t target = pushed.load(std::memory_order_acquire);
+				std::lock_guard<std::mutex> guard(outputLock);
+				// Records claimed before target may still be being filled in
+				while (written.load(std::memory_order_acquire) < target)
+				{
+					Drain();
+					if (written.load(std::memory_order_acquire) < target) std::this_thread::yield();
+				}
+			}
+
+			template<class... _Args>
+			void Push(LogLevel level, _In_opt_ const char* format, std::string_view message, const _Args&... arguments) noexcept
+			{
+				static_assert(sizeof...(_Args) <= maxArguments, "Too many log arguments");
+				uint64_t position;
+				Record* record = queue.Claim(position);
+				if (!record)
+				{
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				record->format = format;
+				record->level = level;
+				record->argumentCount = 0;
+				record->textSize = 0;
+				record->truncated = false;
+				if (!format)
+				{
+					uint16_t offset, length;
+					record->AppendText(message, offset, length);
+				}
+				(record->Capture(arguments), ...);
+				queue.Publish(position);
+				// Sequentially consistent, like idle's store and load, so either the logging thread sees the new count
+				// before it sleeps or Wake sees it going idle
+				pushed.fetch_add(1);
+				Wake();
+			}
+		};
+
+		// Started by the first log call, and stopped, after writing what is left, at exit
+		inline Logger& GetLogger()
+		{
+			static Logger logger;
+			return logger;
+		}
+	}
+
+	// Messages below minimum are dropped at run time, before anything is copied
+	inline void SetLogLevel(LogLevel minimum) { _Log::minimumLevel.store(minimum, std::memory_order_relaxed); }
+	inline LogLevel GetLogLevel() { return _Log::minimumLevel.load(std::memory_order_relaxed); }
+	// Whether a message at level would be logged, by both DEBUG_LOG_LEVEL and SetLogLevel
+	inline bool IsLogEnabled(LogLevel level)
+	{
+		return level >= compiledLogLevel && level >= _Log::minimumLevel.load(std::memory_order_relaxed);
+	}
+	inline void SetLogOutput(_In_ std::FILE* output) { _Log::GetLogger().SetOutput(output); }
+	inline uint64_t GetLogDroppedCount() { return _Log::GetLogger().GetDroppedCount(); }
+	// Waits until everything logged so far has been written
+	inline void LogFlush() { _Log::GetLogger().Flush(); }
+
+	// A format the logging thread can read after the call has returned. Only constant expressions
+	// can make one, so it can't point into a buffer that may be gone by then. Other strings are
+	// logged as a message, which is copied, and can't take arguments.
+	struct LogFormat
+	{
+		const char* text;
+
+		template<size_t _Size>
+		consteval LogFormat(const char (&format)[_Size]) noexcept : text(format) {}
+	};
+
+	// Queues a message for the logging thread; each {} in format is replaced by the next of arguments
+	template<class... _Args>
+	void LogAt(LogLevel level, LogFormat format, const _Args&... arguments) noexcept
+	{
+		if (IsLogEnabled(level)) _Log::GetLogger().Push(level, format.text, {}, arguments...);
+	}
+	// Queues a copy of message, which needn't outlive the call. Long messages are truncated.
+	// Also taken by a literal with no arguments, as overloads that aren't templates win ties.
+	inline void LogAt(LogLevel level, std::string_view message) noexcept
+	{
+		if (IsLogEnabled(level)) _Log::GetLogger().Push(level, nullptr, message);
+	}
+}
+
+// Logs at level, but only evaluates the arguments when the message will be logged, so e.g.
+// DEBUG_LOG("{}", object.ToString()) costs nothing when logs are filtered out.
+// Below DEBUG_LOG_LEVEL the whole statement compiles to nothing, though it is still checked.
+#define DEBUG_LOG_AT(level, ...) \
+	do \
+	{ \
+		if constexpr ((level) >= ::Debug::compiledLogLevel) \
+		{ \
+			if (::Debug::IsLogEnabled(level)) ::Debug::LogAt((level), __VA_ARGS__); \
+		} \
+	} while (false)
+#define DEBUG_LOG(...) DEBUG_LOG_AT(::Debug::LogLevel::log, __VA_ARGS__)
+#define DEBUG_LOG_WARNING(...) DEBUG_LOG_AT(::Debug::LogLevel::warning, __VA_ARGS__)
+#define DEBUG_LOG_ERROR(...) DEBUG_LOG_AT(::Debug::LogLevel::error, __VA_ARGS__)
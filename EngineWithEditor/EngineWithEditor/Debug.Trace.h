@@ -0,0 +1,283 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Platform.h"
+
+/*************************************************************
+* Timeline tracing in the Chrome trace event format, which
+* chrome://tracing, Perfetto (ui.perfetto.dev) and Speedscope
+* all open.
+*
+* Each thread records into its own fixed-size buffer with no
+* locks: the thread is the only writer, and TraceFlush the only
+* reader. A thread whose buffer is full drops events until the
+* next flush instead of waiting, and the drops are counted in
+* the trace. Nothing is recorded unless a trace is started.
+*
+* Names are stored as pointers, so they must outlive the trace;
+* string literals are the usual choice.
+*************************************************************/
+namespace Debug
+{
+	namespace _Trace
+	{
+		enum class EventType : uint8_t
+		{
+			begin,
+			end,
+			counter,
+		};
+
+		struct Event
+		{
+			const char* name;
+			int64_t time; // steady_clock nanoseconds
+			double value; // Counters only
+			EventType type;
+		};
+
+		// Per thread; must be a power of two
+		constexpr size_t bufferSize = 1 << 16;
+
+		struct ThreadBuffer
+		{
+			std::unique_ptr<Event[]> events = std::make_unique<Event[]>(bufferSize);
+			std::atomic<uint64_t> written = 0; // Only the owning thread stores
+			std::atomic<uint64_t> read = 0;    // Only TraceFlush stores
+			std::atomic<uint64_t> dropped = 0;
+			std::atomic<const char*> threadName = nullptr;
+			uint32_t id;
+		};
+
+		inline std::atomic<bool> tracing = false;
+		inline std::mutex lock; // Guards everything below
+		// Kept after their threads exit, so what they recorded still gets flushed
+		inline std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		inline std::FILE* file = nullptr;
+		inline bool firstEvent = true;
+		inline int64_t startTime = 0;
+
+		inline int64_t Now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		inline ThreadBuffer& LocalBuffer()
+		{
+			thread_local std::shared_ptr<ThreadBuffer> buffer = []
+			{
+				std::shared_ptr<ThreadBuffer> created = std::make_shared<ThreadBuffer>();
+				std::lock_guard<std::mutex> guard(lock);
+				created->id = (uint32_t)buffers.size() + 1;
+				buffers.push_back(created);
+				return created;
+			}();
+			return *buffer;
+		}
+
+		inline void Record(const char* name, EventType type, double value = 0) noexcept
+		{
+			if (!tracing.load(std::memory_order_relaxed)) return;
+			int64_t time = Now();
+			ThreadBuffer& buffer = LocalBuffer();
+			uint64_t written = buffer.written.load(std::memory_order_relaxed);
+			if (written - buffer.read.load(std::memory_order_acquire) >= bufferSize)
+			{
+				buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			buffer.events[written & (bufferSize - 1)] = { name, time, value, type };
+			buffer.written.store(written + 1, std::memory_order_release);
+		}
+
+		// Events are formatted here and written with one fwrite per flush, since every
+		// stdio call takes the FILE's lock
+		inline std::string text;
+
+		inline void AppendString(const char* value)
+		{
+			text += '"';
+			for (const char* c = value; *c; ++c)
+			{
+				if (*c == '"' || *c == '\\') text += '\\';
+				if ((unsigned char)*c >= 0x20)
+				{
+					text += *c;
+					continue;
+				}
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*c);
+				text += escaped;
+			}
+			text += '"';
+		}
+
+		inline void AppendInteger(long long value)
+		{
+			char digits[24];
+			std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+			text.append(digits, result.ptr);
+		}
+
+		// Starts an event object with the fields every event has. Trace timestamps are microseconds since the trace started.
+		// snprintf would be simpler, but is most of the cost of a flush.
+		inline void AppendEvent(char phase, uint32_t thread, int64_t time)
+		{
+			long long nanoseconds = std::max<long long>(time - startTime, 0);
+			text += firstEvent ? "\n{\"ph\":\"" : ",\n{\"ph\":\"";
+			text += phase;
+			text += "\",\"pid\":1,\"tid\":";
+			AppendInteger(thread);
+			text += ",\"ts\":";
+			AppendInteger(nanoseconds / 1000);
+			char fraction[4] = { '.', (char)('0' + nanoseconds / 100 % 10), (char)('0' + nanoseconds / 10 % 10), (char)('0' + nanoseconds % 10) };
+			text.append(fraction, sizeof(fraction));
+			firstEvent = false;
+		}
+
+		// Formats everything buffer holds into text. Call with lock held.
+		inline void Drain(ThreadBuffer& buffer)
+		{
+			uint64_t read = buffer.read.load(std::memory_order_relaxed);
+			uint64_t written = buffer.written.load(std::memory_order_acquire);
+			for (; read < written; ++read)
+			{
+				const Event& event = buffer.events[read & (bufferSize - 1)];
+				switch (event.type)
+				{
+				case EventType::begin:
+				case EventType::end:
+					AppendEvent(event.type == EventType::begin ? 'B' : 'E', buffer.id, event.time);
+					text += ",\"name\":";
+					AppendString(event.name);
+					text += '}';
+					break;
+				case EventType::counter:
+				{
+					AppendEvent('C', buffer.id, event.time);
+					text += ",\"name\":";
+					AppendString(event.name);
+					char value[48];
+					int length = std::snprintf(value, sizeof(value), ",\"args\":{\"value\":%.17g}}", event.value);
+					text.append(value, (size_t)std::max(length, 0));
+					break;
+				}
+				}
+			}
+			buffer.read.store(read, std::memory_order_release);
+
+			uint64_t dropped = buffer.dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped)
+			{
+				AppendEvent('i', buffer.id, Now());
+				text += ",\"s\":\"t\",\"name\":\"Dropped " + std::to_string(dropped) + " events\"}";
+			}
+		}
+
+		// Writes out what Drain formatted. Call with lock held.
+		inline void Write()
+		{
+			std::fwrite(text.data(), 1, text.size(), file);
+			text.clear();
+		}
+	}
+
+	// Starts recording to a new trace file at path. Returns false if it can't be created.
+	inline bool TraceStart(_In_z_ const char* path)
+	{
+		std::lock_guard<std::mutex> guard(_Trace::lock);
+		_ASSERT_EXPR(!_Trace::file, L"A trace is already being recorded");
+		_Trace::file = std::fopen(path, "w");
+		if (!_Trace::file) return false;
+		std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", _Trace::file);
+		_Trace::firstEvent = true;
+		_Trace::startTime = _Trace::Now();
+		// Whatever was recorded before is from an earlier trace
+		for (const std::shared_ptr<_Trace::ThreadBuffer>& buffer : _Trace::buffers)
+		{
+			buffer->read.store(buffer->written.load(std::memory_order_acquire), std::memory_order_release);
+			buffer->dropped.store(0, std::memory_order_relaxed);
+		}
+		_Trace::tracing.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	inline bool IsTracing() { return _Trace::tracing.load(std::memory_order_relaxed); }
+
+	// Writes what every thread has recorded so far to the trace file, freeing their buffers.
+	// Call regularly, e.g. once a frame, from any one thread.
+	inline void TraceFlush()
+	{
+		std::lock_guard<std::mutex> guard(_Trace::lock);
+		if (!_Trace::file) return;
+		for (const std::shared_ptr<_Trace::ThreadBuffer>& buffer : _Trace::buffers)
+		{
+			_Trace::Drain(*buffer);
+		}
+		_Trace::Write();
+		std::fflush(_Trace::file);
+	}
+
+	// Stops recording, flushes, and closes the trace file.
+	// Scopes still open on other threads are left without an end.
+	inline void TraceStop()
+	{
+		_Trace::tracing.store(false, std::memory_order_relaxed);
+		std::lock_guard<std::mutex> guard(_Trace::lock);
+		if (!_Trace::file) return;
+		for (const std::shared_ptr<_Trace::ThreadBuffer>& buffer : _Trace::buffers)
+		{
+			_Trace::Drain(*buffer);
+			const char* name = buffer->threadName.load(std::memory_order_relaxed);
+			if (!name) continue;
+			_Trace::AppendEvent('M', buffer->id, _Trace::startTime);
+			_Trace::text += ",\"name\":\"thread_name\",\"args\":{\"name\":";
+			_Trace::AppendString(name);
+			_Trace::text += "}}";
+		}
+		_Trace::text += "\n]}\n";
+		_Trace::Write();
+		std::fclose(_Trace::file);
+		_Trace::file = nullptr;
+	}
+
+	// Names the calling thread in traces
+	inline void TraceThreadName(_In_z_ const char* name) noexcept
+	{
+		_Trace::LocalBuffer().threadName.store(name, std::memory_order_relaxed);
+	}
+
+	// Begins a slice on the calling thread's timeline, which lasts until the matching TraceEnd
+	inline void TraceBegin(_In_z_ const char* name) noexcept { _Trace::Record(name, _Trace::EventType::begin); }
+	// Ends the innermost slice TraceBegin started on the calling thread
+	inline void TraceEnd(_In_z_ const char* name) noexcept { _Trace::Record(name, _Trace::EventType::end); }
+	// Plots value on a graph called name
+	inline void TraceCounter(_In_z_ const char* name, double value) noexcept { _Trace::Record(name, _Trace::EventType::counter, value); }
+
+	// Traces the rest of the enclosing block. Use DEBUG_TRACE_SCOPE("name") rather than this directly.
+	class TraceScope
+	{
+	private:
+		const char* name;
+
+	public:
+		explicit TraceScope(_In_z_ const char* name) noexcept : name(name) { TraceBegin(name); }
+		~TraceScope() noexcept { TraceEnd(name); }
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+	};
+}
+
+#define _DEBUG_TRACE_CONCAT2(a, b) a##b
+#define _DEBUG_TRACE_CONCAT(a, b) _DEBUG_TRACE_CONCAT2(a, b)
+// Traces the rest of the enclosing block as a slice called name
+#define DEBUG_TRACE_SCOPE(name) ::Debug::TraceScope _DEBUG_TRACE_CONCAT(_traceScope, __LINE__)(name)
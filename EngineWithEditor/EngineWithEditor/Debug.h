@@ -1,4 +1,8 @@
 #pragma once
+#include <stdexcept>
+#include <string_view>
+#include "Debug.Log.h"
+#include "Debug.Trace.h"
 namespace rl {
 #include <raylib.h>
 }
@@ -6,31 +10,50 @@ namespace rl {
 // Todo
 namespace Debug
 {
-#if _DEBUG
-	void Log(_In_z_ const char* message) noexcept(noexcept(printf))
+	// Messages are queued and written by a background thread (see Debug.Log.h), so logging doesn't stall the caller.
+	// With a literal format, each {} in it is replaced by the next argument; other strings are copied as they are.
+	// Levels below DEBUG_LOG_LEVEL compile to nothing, but arguments are still evaluated; the DEBUG_LOG macros
+	// skip evaluating them too.
+	template<class... _Args>
+	void Log(LogFormat format, const _Args&... arguments) noexcept
+	{
+		if constexpr (LogLevel::log >= compiledLogLevel) LogAt(LogLevel::log, format, arguments...);
+	}
+	inline void Log(std::string_view message) noexcept
+	{
+		if constexpr (LogLevel::log >= compiledLogLevel) LogAt(LogLevel::log, message);
+	}
+	template<class... _Args>
+	void LogWarning(LogFormat format, const _Args&... arguments) noexcept
 	{
-		printf("Log | %s", message);
+		if constexpr (LogLevel::warning >= compiledLogLevel) LogAt(LogLevel::warning, format, arguments...);
 	}
-	void LogWarning(_In_z_ const char* message) noexcept(noexcept(printf))
+	inline void LogWarning(std::string_view message) noexcept
 	{
-		printf("Warning | %s", message);
+		if constexpr (LogLevel::warning >= compiledLogLevel) LogAt(LogLevel::warning, message);
 	}
-	void LogError(_In_z_ const char* message) noexcept(noexcept(printf))
+	template<class... _Args>
+	void LogError(LogFormat format, const _Args&... arguments) noexcept
 	{
-		printf("Error | %s", message);
+		if constexpr (LogLevel::error >= compiledLogLevel) LogAt(LogLevel::error, format, arguments...);
 	}
-	[[ noreturn ]] void LogAssertion(bool condition, _In_z_ const char* message) noexcept(false)
+	inline void LogError(std::string_view message) noexcept
+	{
+		if constexpr (LogLevel::error >= compiledLogLevel) LogAt(LogLevel::error, message);
+	}
+
+#if _DEBUG
+	inline void LogAssertion(bool condition, _In_z_ const char* message) noexcept(false)
 	{
 		if (!condition)
 		{
-			printf("Assertion Failed | %s", message);
-			throw std::exception("Failed assertion");
+			LogAt(LogLevel::error, "Assertion Failed | {}", message);
+			// Everything before the assertion should be out before whatever catches the exception
+			LogFlush();
+			throw std::logic_error("Failed assertion");
 		}
 	}
 #else
-	void Log(_In_z_ const char* message) noexcept {}
-	void LogWarning(_In_z_ const char* message) noexcept {}
-	void LogError(_In_z_ const char* message) noexcept {}
-	void LogAssertion(bool condition, _In_z_ const char* message) noexcept {}
+	inline void LogAssertion(bool, _In_z_ const char*) noexcept {}
 #endif
 }
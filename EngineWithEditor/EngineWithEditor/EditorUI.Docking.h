@@ -0,0 +1,413 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "EditorUI.h"
+
+namespace EditorUI
+{
+	/*************************************************************
+	* Docks panes into a binary tree of splits that fills an area.
+	*
+	* Each split divides its rect between two children along one
+	* axis by a ratio; leaves hold a pane. Docking, undocking and
+	* moving a split only lay out again from the highest node whose
+	* rect can change, which is usually the changed node itself.
+	* It only goes further up the path to the root while a node's
+	* minimum size changes.
+	*
+	* The edge regions of every docked pane (see SnapRect) are
+	* kept in a uniform grid, so finding the snap target under the
+	* cursor while dragging doesn't have to test every pane.
+	*************************************************************/
+	class DockTree
+	{
+	public:
+		using NodeId = int;
+		static constexpr NodeId none = -1;
+
+		enum class Axis { x, y };
+
+		// Where a pane would be docked. region is floating if there is nowhere to dock.
+		struct Target
+		{
+			NodeId node = none; // Leaf to split, or none when docking into the empty tree, which it then fills
+			SnapRect::Region region = SnapRect::Region::floating;
+
+			explicit operator bool() const { return region != SnapRect::Region::floating; }
+		};
+
+	private:
+		// Size of a cell in the snap region grid
+		static constexpr float cellSize = 64;
+
+		struct Node
+		{
+			Pane* pane = nullptr; // Leaves only
+			Axis axis = Axis::x;  // Splits only
+			float ratio = 0.5f;   // Splits only; share of the rect given to children[0]
+			NodeId children[2] = { none, none };
+			NodeId parent = none;
+			rl::Rectangle rect = {};
+			rl::Vector2 minSize = {};
+			bool dirty = false; // Needs laying out even if its rect is unchanged
+
+			bool IsLeaf() const { return pane != nullptr; }
+		};
+
+		struct SnapEntry
+		{
+			rl::Rectangle rect;
+			NodeId node;
+			SnapRect::Region region;
+		};
+
+		std::vector<Node> nodes;
+		std::vector<NodeId> freeNodes;
+		std::unordered_map<const Pane*, NodeId> leaves;
+		NodeId root = none;
+		rl::Rectangle area = {};
+		size_t lastLayoutCount = 0;
+
+		std::vector<SnapEntry> snapEntries;
+		std::unordered_map<uint64_t, std::vector<uint32_t>> snapCells;
+		bool snapIndexValid = false;
+
+		static bool SameRect(const rl::Rectangle& a, const rl::Rectangle& b)
+		{
+			return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+		}
+		// Same rule as rl::CheckCollisionPointRec
+		static bool Contains(const rl::Rectangle& rect, rl::Vector2 point)
+		{
+			return point.x >= rect.x && point.x < rect.x + rect.width && point.y >= rect.y && point.y < rect.y + rect.height;
+		}
+		static int CellCoord(float value) { return (int)std::floor(value / cellSize); }
+		static uint64_t CellKey(int x, int y) { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y; }
+
+		NodeId NewNode()
+		{
+			if (!freeNodes.empty())
+			{
+				NodeId id = freeNodes.back();
+				freeNodes.pop_back();
+				nodes[id] = {};
+				return id;
+			}
+			nodes.emplace_back();
+			return (NodeId)nodes.size() - 1;
+		}
+		void FreeNode(NodeId id)
+		{
+			nodes[id] = {};
+			freeNodes.push_back(id);
+		}
+
+		// Points whatever referred to from (its parent, or the root) at to instead
+		void ReplaceChild(NodeId parent, NodeId from, NodeId to)
+		{
+			if (parent == none)
+			{
+				root = to;
+			}
+			else
+			{
+				Node& node = nodes[parent];
+				node.children[node.children[0] == from ? 0 : 1] = to;
+			}
+			if (to != none) nodes[to].parent = parent;
+		}
+
+		rl::Vector2 ComputeMinSize(NodeId id) const
+		{
+			const Node& node = nodes[id];
+			if (node.IsLeaf()) return { Pane::minSize, Pane::minSize };
+
+			rl::Vector2 a = nodes[node.children[0]].minSize;
+			rl::Vector2 b = nodes[node.children[1]].minSize;
+			if (node.axis == Axis::x) return { a.x + b.x, std::max(a.y, b.y) };
+			return { std::max(a.x, b.x), a.y + b.y };
+		}
+		// Returns whether the minimum size changed
+		bool UpdateMinSize(NodeId id)
+		{
+			rl::Vector2 minSize = ComputeMinSize(id);
+			Node& node = nodes[id];
+			bool changed = minSize.x != node.minSize.x || minSize.y != node.minSize.y;
+			node.minSize = minSize;
+			return changed;
+		}
+
+		void Layout(NodeId id, rl::Rectangle rect)
+		{
+			Node& node = nodes[id];
+			if (!node.dirty && SameRect(node.rect, rect)) return; // Nothing below can have changed
+			node.rect = rect;
+			node.dirty = false;
+			++lastLayoutCount;
+
+			if (node.IsLeaf())
+			{
+				node.pane->SetRect(rect);
+				return;
+			}
+
+			bool alongX = node.axis == Axis::x;
+			float size = alongX ? rect.width : rect.height;
+			float minFirst = alongX ? nodes[node.children[0]].minSize.x : nodes[node.children[0]].minSize.y;
+			float minSecond = alongX ? nodes[node.children[1]].minSize.x : nodes[node.children[1]].minSize.y;
+			float first = std::round(size * node.ratio);
+			// If there isn't room for both minimums, the ratio is kept and the panes overflow
+			if (size >= minFirst + minSecond) first = std::clamp(first, minFirst, size - minSecond);
+
+			rl::Rectangle a = rect, b = rect;
+			if (alongX)
+			{
+				a.width = first;
+				b.x += first;
+				b.width -= first;
+			}
+			else
+			{
+				a.height = first;
+				b.y += first;
+				b.height -= first;
+			}
+			Layout(node.children[0], a);
+			Layout(node.children[1], b);
+		}
+
+		// Lays out what changed because of a change to id, which must already have its rect
+		void Relayout(NodeId id)
+		{
+			ENGINE_PROFILE_SCOPE("DockTree::Relayout");
+			lastLayoutCount = 0;
+			snapIndexValid = false;
+
+			// A node whose minimum size changed can be clamped differently by its parent,
+			// so the layout has to start above it
+			NodeId start = id;
+			nodes[id].dirty = true;
+			bool changed = UpdateMinSize(id);
+			while (changed && nodes[start].parent != none)
+			{
+				start = nodes[start].parent;
+				nodes[start].dirty = true;
+				changed = UpdateMinSize(start);
+			}
+
+			// Nodes between start and id may keep their rects, but must still be walked through to reach id
+			for (NodeId node = id; node != start; node = nodes[node].parent)
+			{
+				nodes[node].dirty = true;
+			}
+			Layout(start, start == root ? area : nodes[start].rect);
+		}
+
+		void BuildSnapIndex()
+		{
+			snapEntries.clear();
+			for (auto& [key, cell] : snapCells)
+			{
+				cell.clear();
+			}
+
+			for (const auto& [pane, id] : leaves)
+			{
+				SnapRect snap(nodes[id].rect);
+				// The center region is left out; it is reserved for tabbing panes together
+				for (SnapRect::Region region : { SnapRect::Region::top, SnapRect::Region::right, SnapRect::Region::bottom, SnapRect::Region::left })
+				{
+					const rl::Rectangle& rect = *snap.RectFromRegion(region);
+					if (rect.width <= 0 || rect.height <= 0) continue;
+
+					uint32_t index = (uint32_t)snapEntries.size();
+					snapEntries.push_back({ rect, id, region });
+
+					int xEnd = CellCoord(rect.x + rect.width);
+					int yEnd = CellCoord(rect.y + rect.height);
+					for (int y = CellCoord(rect.y); y <= yEnd; ++y)
+					{
+						for (int x = CellCoord(rect.x); x <= xEnd; ++x)
+						{
+							snapCells[CellKey(x, y)].push_back(index);
+						}
+					}
+				}
+			}
+			snapIndexValid = true;
+		}
+
+	public:
+		// The rect the docked panes fill, usually the window's
+		void SetArea(rl::Rectangle rect)
+		{
+			area = rect;
+			if (root != none) Relayout(root);
+		}
+		rl::Rectangle GetArea() const { return area; }
+
+		bool IsDocked(const Pane& pane) const { return leaves.contains(&pane); }
+		size_t GetDockedCount() const { return leaves.size(); }
+		// Nodes laid out by the most recent change, for checking the layout stays incremental
+		size_t GetLastLayoutCount() const { return lastLayoutCount; }
+
+		// The snap target under point, if any
+		Target FindTarget(rl::Vector2 point)
+		{
+			if (!Contains(area, point)) return {};
+			if (root == none)
+			{
+				// Only the area's edges snap, as with docked panes, so a pane dropped anywhere else stays floating
+				SnapRect::Region region = SnapRect(area).CheckCollision(point);
+				if (region == SnapRect::Region::floating || region == SnapRect::Region::center) return {};
+				return { none, region };
+			}
+
+			if (!snapIndexValid) BuildSnapIndex();
+			auto it = snapCells.find(CellKey(CellCoord(point.x), CellCoord(point.y)));
+			if (it == snapCells.end()) return {};
+
+			// A pane's regions overlap at its corners; the first one added wins, as in SnapRect::CheckCollision.
+			// Regions of different panes never overlap.
+			for (uint32_t index : it->second)
+			{
+				const SnapEntry& entry = snapEntries[index];
+				if (Contains(entry.rect, point)) return { entry.node, entry.region };
+			}
+			return {};
+		}
+
+		// Where a pane docked at target would end up, for previewing the dock while dragging
+		rl::Rectangle GetTargetRect(Target target) const
+		{
+			if (!target) return {};
+			if (target.node == none) return area;
+
+			rl::Rectangle rect = nodes[target.node].rect;
+			switch (target.region)
+			{
+			case SnapRect::Region::top:    rect.height *= 0.5f; break;
+			case SnapRect::Region::left:   rect.width *= 0.5f; break;
+			case SnapRect::Region::bottom: rect.height *= 0.5f; rect.y += rect.height; break;
+			case SnapRect::Region::right:  rect.width *= 0.5f; rect.x += rect.width; break;
+			default: break;
+			}
+			return rect;
+		}
+
+		// Splits target's pane in half and puts pane on the target's side
+		void Dock(Pane& pane, Target target)
+		{
+			_ASSERT_EXPR(!IsDocked(pane), L"Pane is already docked");
+			_ASSERT_EXPR(target, L"Target must be a dockable region");
+
+			NodeId leaf = NewNode();
+			nodes[leaf].pane = &pane;
+			leaves[&pane] = leaf;
+
+			if (target.node == none)
+			{
+				_ASSERT_EXPR(root == none, L"Only an empty tree can be docked into without a target pane");
+				root = leaf;
+				Relayout(leaf);
+				return;
+			}
+
+			NodeId existing = target.node;
+			_ASSERT_EXPR(nodes[existing].IsLeaf(), L"Target must be a docked pane");
+			bool first = target.region == SnapRect::Region::top || target.region == SnapRect::Region::left;
+
+			NodeId split = NewNode();
+			ReplaceChild(nodes[existing].parent, existing, split);
+			Node& node = nodes[split];
+			node.axis = (target.region == SnapRect::Region::left || target.region == SnapRect::Region::right) ? Axis::x : Axis::y;
+			node.rect = nodes[existing].rect;
+			node.minSize = nodes[existing].minSize; // So Relayout only goes further up if docking changed it
+			node.children[0] = first ? leaf : existing;
+			node.children[1] = first ? existing : leaf;
+			nodes[existing].parent = split;
+			nodes[leaf].parent = split;
+			UpdateMinSize(leaf);
+			Relayout(split);
+		}
+
+		// Removes pane from the tree, giving its space to its sibling. The pane keeps its rect.
+		void Undock(const Pane& pane)
+		{
+			auto it = leaves.find(&pane);
+			_ASSERT_EXPR(it != leaves.end(), L"Pane is not docked");
+			NodeId leaf = it->second;
+			leaves.erase(it);
+			snapIndexValid = false;
+
+			NodeId parent = nodes[leaf].parent;
+			FreeNode(leaf);
+			if (parent == none)
+			{
+				root = none;
+				lastLayoutCount = 0;
+				return;
+			}
+
+			NodeId sibling = nodes[parent].children[nodes[parent].children[0] == leaf ? 1 : 0];
+			NodeId grandparent = nodes[parent].parent;
+			rl::Rectangle rect = nodes[parent].rect;
+			ReplaceChild(grandparent, parent, sibling);
+			FreeNode(parent);
+
+			// The sibling takes the parent's rect. Its new parent's minimum size has to be recomputed,
+			// but that parent's other child keeps its rect and is skipped.
+			nodes[sibling].rect = rect;
+			nodes[sibling].dirty = true;
+			Relayout(grandparent != none ? grandparent : sibling);
+		}
+
+		// Moves the split at pane's right or bottom edge by delta, as when dragging that edge
+		void Resize(const Pane& pane, rl::Vector2 delta)
+		{
+			auto it = leaves.find(&pane);
+			_ASSERT_EXPR(it != leaves.end(), L"Pane is not docked");
+
+			for (Axis axis : { Axis::x, Axis::y })
+			{
+				float amount = axis == Axis::x ? delta.x : delta.y;
+				if (amount == 0) continue;
+
+				// The nearest split along axis that pane is on the first side of owns that edge
+				NodeId child = it->second;
+				NodeId split = nodes[child].parent;
+				while (split != none && !(nodes[split].axis == axis && nodes[split].children[0] == child))
+				{
+					child = split;
+					split = nodes[split].parent;
+				}
+				if (split == none) continue; // The edge is the area's
+
+				const Node& node = nodes[split];
+				float size = axis == Axis::x ? node.rect.width : node.rect.height;
+				float first = axis == Axis::x ? nodes[child].rect.width : nodes[child].rect.height;
+				if (size > 0) SetRatio(split, (first + amount) / size);
+			}
+		}
+
+		void SetRatio(NodeId split, float ratio)
+		{
+			_ASSERT_EXPR(split >= 0 && split < (NodeId)nodes.size() && !nodes[split].IsLeaf(), L"Not a split");
+			nodes[split].ratio = std::clamp(ratio, 0.0f, 1.0f);
+			Relayout(split);
+		}
+
+		void Clear()
+		{
+			nodes.clear();
+			freeNodes.clear();
+			leaves.clear();
+			root = none;
+			lastLayoutCount = 0;
+			snapIndexValid = false;
+		}
+	};
+}
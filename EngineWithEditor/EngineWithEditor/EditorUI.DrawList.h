@@ -0,0 +1,271 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "Platform.h"
+#include "Engine.Profiler.h"
+#include "EditorUI.DrawSink.h"
+#include "EditorUI.TextCache.h"
+namespace rl {
+#include <raylib.h>
+}
+
+namespace EditorUI
+{
+	/*************************************************************
+	* Collects a frame's UI draws so they can be submitted in as
+	* few batches as possible.
+	*
+	* raylib batches consecutive draws on its own, but has to
+	* flush whenever the shader or texture changes. Submit groups
+	* commands by shader and texture, only moving a command ahead
+	* of others it doesn't overlap, so the result looks the same
+	* as drawing everything in the order it was added.
+	*************************************************************/
+	class DrawList
+	{
+	private:
+		enum class Kind { rect, rectLines, texture, text };
+
+		// The render state a command needs. Commands with equal materials can share a batch.
+		struct Material
+		{
+			unsigned int shader;  // 0 for raylib's default shader
+			unsigned int texture;
+
+			bool operator==(const Material&) const = default;
+		};
+
+		struct Command
+		{
+			Kind kind;
+			Material material;
+			rl::Rectangle rect; // Also the bounds used to test for overlap
+			rl::Color color;
+			rl::Rectangle source; // texture
+			rl::Texture texture;  // texture
+			const TextRun* run;   // text
+			float lineThick;      // rectLines
+		};
+
+		struct Batch
+		{
+			Material material;
+			rl::Shader shader;
+			rl::Rectangle bounds;
+			std::vector<size_t> commands;
+		};
+
+		IDrawSink* sink;
+		std::vector<Command> commands;
+		std::vector<Batch> batches;
+		size_t batchesUsed = 0; // Batches are reused between frames to keep their allocations
+		std::vector<rl::Shader> shaders; // BeginShaderMode stack
+		unsigned int shapesTexture = 0;
+		size_t lastBatchCount = 0;
+
+		static bool Overlaps(const rl::Rectangle& a, const rl::Rectangle& b)
+		{
+			return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+		}
+		static rl::Rectangle Union(const rl::Rectangle& a, const rl::Rectangle& b)
+		{
+			float xMin = std::min(a.x, b.x);
+			float yMin = std::min(a.y, b.y);
+			float xMax = std::max(a.x + a.width, b.x + b.width);
+			float yMax = std::max(a.y + a.height, b.y + b.height);
+			return { xMin, yMin, xMax - xMin, yMax - yMin };
+		}
+
+		Material MaterialFor(unsigned int texture) const
+		{
+			return { shaders.empty() ? 0u : shaders.back().id, texture };
+		}
+		// raylib draws shapes with its default font's texture unless told otherwise,
+		// which lets shapes and text share a batch
+		unsigned int ShapesTexture()
+		{
+			if (!shapesTexture) shapesTexture = rl::GetFontDefault().texture.id;
+			return shapesTexture;
+		}
+
+		bool OverlapsBatch(const Batch& batch, const rl::Rectangle& rect) const
+		{
+			if (!Overlaps(batch.bounds, rect)) return false;
+			for (size_t index : batch.commands)
+			{
+				if (Overlaps(commands[index].rect, rect)) return true;
+			}
+			return false;
+		}
+
+		// Finds the earliest batch the command can join without drawing over
+		// anything it overlaps, or starts a new batch at the end
+		void Assign(size_t index)
+		{
+			const Command& command = commands[index];
+			size_t target = batchesUsed;
+			for (size_t i = batchesUsed; i-- > 0;)
+			{
+				if (batches[i].material == command.material)
+				{
+					target = i;
+					break;
+				}
+				if (OverlapsBatch(batches[i], command.rect)) break;
+			}
+
+			if (target == batchesUsed)
+			{
+				if (batchesUsed == batches.size()) batches.emplace_back();
+				Batch& batch = batches[batchesUsed++];
+				batch.material = command.material;
+				batch.shader = shaders.empty() ? rl::Shader{} : shaders.back();
+				batch.bounds = command.rect;
+				batch.commands.clear();
+			}
+			Batch& batch = batches[target];
+			batch.bounds = Union(batch.bounds, command.rect);
+			batch.commands.push_back(index);
+		}
+
+		void Issue(const Command& command) const
+		{
+			switch (command.kind)
+			{
+			case Kind::rect:
+				sink->DrawRectangle(command.rect, command.color);
+				break;
+			case Kind::rectLines:
+				sink->DrawRectangleLines(command.rect, command.lineThick, command.color);
+				break;
+			case Kind::texture:
+				sink->DrawTexture(command.texture, command.source, command.rect, command.color);
+				break;
+			case Kind::text:
+				for (const TextRun::Glyph& glyph : command.run->glyphs)
+				{
+					rl::Rectangle dest = { command.rect.x + glyph.dest.x, command.rect.y + glyph.dest.y, glyph.dest.width, glyph.dest.height };
+					sink->DrawTexture(command.run->font.texture, glyph.source, dest, command.color);
+				}
+				break;
+			}
+		}
+
+		void Add(const Command& command)
+		{
+			commands.push_back(command);
+			Assign(commands.size() - 1);
+		}
+
+	public:
+		DrawList() : DrawList(DefaultDrawSink()) {}
+		// Submits to sink instead of raylib, which must outlive the list
+		explicit DrawList(IDrawSink& sink) : sink(&sink) {}
+
+		// Sets the sink's shapes texture, so the list knows which draws share a texture.
+		// Call while the list is empty.
+		void SetShapesTexture(rl::Texture texture, rl::Rectangle source)
+		{
+			sink->SetShapesTexture(texture, source);
+			shapesTexture = texture.id;
+		}
+
+		// Commands added until the matching EndShaderMode are drawn with shader.
+		// Nests, unlike rl::BeginShaderMode.
+		void BeginShaderMode(rl::Shader shader)
+		{
+			shaders.push_back(shader);
+		}
+		void EndShaderMode()
+		{
+			_ASSERT_EXPR(!shaders.empty(), L"EndShaderMode without BeginShaderMode");
+			shaders.pop_back();
+		}
+
+		void DrawRectangle(rl::Rectangle rect, rl::Color color)
+		{
+			Command command = {};
+			command.kind = Kind::rect;
+			command.material = MaterialFor(ShapesTexture());
+			command.rect = rect;
+			command.color = color;
+			Add(command);
+		}
+		void DrawRectangleLines(rl::Rectangle rect, float lineThick, rl::Color color)
+		{
+			Command command = {};
+			command.kind = Kind::rectLines;
+			command.material = MaterialFor(ShapesTexture());
+			command.rect = rect;
+			command.color = color;
+			command.lineThick = lineThick;
+			Add(command);
+		}
+		void DrawRectangleOutlined(rl::Rectangle rect, rl::Color fillColor, rl::Color linesColor)
+		{
+			DrawRectangle(rect, fillColor);
+			DrawRectangleLines(rect, 1.0f, linesColor);
+		}
+		void DrawTexture(rl::Texture texture, rl::Rectangle source, rl::Rectangle dest, rl::Color tint)
+		{
+			Command command = {};
+			command.kind = Kind::texture;
+			command.material = MaterialFor(texture.id);
+			command.rect = dest;
+			command.color = tint;
+			command.source = source;
+			command.texture = texture;
+			Add(command);
+		}
+		// run must stay valid until Submit (see TextCache::Clear)
+		void DrawText(const TextRun& run, int x, int y, rl::Color color)
+		{
+			Command command = {};
+			command.kind = Kind::text;
+			command.material = MaterialFor(run.font.texture.id);
+			command.rect = { (float)x, (float)y, run.width, run.height };
+			command.color = color;
+			command.run = &run;
+			Add(command);
+		}
+
+		size_t GetCommandCount() const { return commands.size(); }
+		// Batches the commands currently fall into, i.e. the draw calls Submit will make
+		size_t GetBatchCount() const { return batchesUsed; }
+		// Batch count of the most recent Submit
+		size_t GetLastBatchCount() const { return lastBatchCount; }
+
+		// Draws everything to the sink, one batch at a time, and clears the list for the next frame.
+		// With raylib, call between BeginDrawing and EndDrawing.
+		void Submit()
+		{
+			ENGINE_PROFILE_SCOPE("DrawList::Submit");
+			unsigned int currentShader = 0;
+			for (size_t i = 0; i < batchesUsed; ++i)
+			{
+				const Batch& batch = batches[i];
+				if (batch.material.shader != currentShader)
+				{
+					if (currentShader) sink->EndShaderMode();
+					if (batch.material.shader) sink->BeginShaderMode(batch.shader);
+					currentShader = batch.material.shader;
+				}
+				for (size_t index : batch.commands)
+				{
+					Issue(commands[index]);
+				}
+			}
+			if (currentShader) sink->EndShaderMode();
+
+			lastBatchCount = batchesUsed;
+			Clear();
+		}
+
+		void Clear()
+		{
+			commands.clear();
+			batchesUsed = 0;
+			shaders.clear();
+		}
+	};
+}
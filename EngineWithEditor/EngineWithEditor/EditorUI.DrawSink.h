@@ -0,0 +1,54 @@
+#pragma once
+#include "Platform.h"
+namespace rl {
+#include <raylib.h>
+}
+
+namespace EditorUI
+{
+	/*************************************************************
+	* Where a DrawList sends its draws when it is submitted.
+	*
+	* The primitives are the few the UI is built from; text
+	* arrives as one textured quad per glyph. RaylibDrawSink draws
+	* them, HeadlessDrawSink (EditorUI.HeadlessDrawSink.h) records
+	* and optionally rasterizes them without a window.
+	*************************************************************/
+	__interface IDrawSink
+	{
+		// As rl::SetShapesTexture: the texture and source rect rectangles are drawn with
+		virtual void SetShapesTexture(rl::Texture texture, rl::Rectangle source) = 0;
+		virtual void BeginShaderMode(rl::Shader shader) = 0;
+		virtual void EndShaderMode() = 0;
+
+		virtual void DrawRectangle(rl::Rectangle rect, rl::Color color) = 0;
+		virtual void DrawRectangleLines(rl::Rectangle rect, float lineThick, rl::Color color) = 0;
+		virtual void DrawTexture(rl::Texture texture, rl::Rectangle source, rl::Rectangle dest, rl::Color tint) = 0;
+	};
+
+	// Draws straight to raylib's current render target
+	class RaylibDrawSink final : public IDrawSink
+	{
+	public:
+		void SetShapesTexture(rl::Texture texture, rl::Rectangle source) override { rl::SetShapesTexture(texture, source); }
+		void BeginShaderMode(rl::Shader shader) override { rl::BeginShaderMode(shader); }
+		void EndShaderMode() override { rl::EndShaderMode(); }
+
+		void DrawRectangle(rl::Rectangle rect, rl::Color color) override { rl::DrawRectangleRec(rect, color); }
+		void DrawRectangleLines(rl::Rectangle rect, float lineThick, rl::Color color) override
+		{
+			rl::DrawRectangleLinesEx(rect, lineThick, color);
+		}
+		void DrawTexture(rl::Texture texture, rl::Rectangle source, rl::Rectangle dest, rl::Color tint) override
+		{
+			rl::DrawTexturePro(texture, source, dest, { 0,0 }, 0.0f, tint);
+		}
+	};
+
+	// The sink DrawLists use unless given another
+	inline IDrawSink& DefaultDrawSink()
+	{
+		static RaylibDrawSink sink;
+		return sink;
+	}
+}
@@ -0,0 +1,257 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include "EditorUI.DrawSink.h"
+
+namespace EditorUI
+{
+	/*************************************************************
+	* A draw sink that needs no window or GPU, for benchmarking and
+	* regression-testing UI frames offline.
+	*
+	* It counts what raylib would be sent: quads, the draw calls
+	* rlgl's batching would turn them into, texture and shader
+	* changes, and vertex bytes. Given a target size it also
+	* rasterizes the frame in software. Rasterizing is simple on
+	* purpose: nearest sampling, pixel centers, shaders ignored,
+	* and rectangles filled with their color regardless of the
+	* shapes texture.
+	*************************************************************/
+	class HeadlessDrawSink final : public IDrawSink
+	{
+	public:
+		struct FrameStats
+		{
+			size_t primitives = 0;     // Quads; every primitive the UI uses is built from them
+			size_t drawCalls = 0;      // Batches, split as rlgl splits them
+			size_t textureChanges = 0;
+			size_t shaderChanges = 0;
+			size_t bytes = 0;          // Vertex data
+
+			size_t GetStateChanges() const { return textureChanges + shaderChanges; }
+		};
+
+	private:
+		// rlgl's default vertex: position (3 floats), texcoord (2 floats), color (4 bytes)
+		static constexpr size_t vertexBytes = 3 * sizeof(float) + 2 * sizeof(float) + 4;
+		// RL_DEFAULT_BATCH_BUFFER_ELEMENTS: quads a batch holds before rlgl has to flush it
+		static constexpr size_t batchQuads = 8192;
+
+		struct TexturePixels
+		{
+			int width, height;
+			std::vector<rl::Color> pixels;
+		};
+
+		unsigned int shapesTexture = 0;
+		unsigned int currentTexture = 0;
+		unsigned int currentShader = 0;
+		bool batchOpen = false;
+		size_t quadsInBatch = 0;
+		FrameStats stats;
+
+		int width = 0, height = 0; // Of the raster target; 0 when not rasterizing
+		std::vector<rl::Color> pixels;
+		std::unordered_map<unsigned int, TexturePixels> textures;
+
+		void AddQuads(unsigned int texture, size_t count)
+		{
+			if (batchOpen && texture != currentTexture) ++stats.textureChanges;
+			if (!batchOpen || texture != currentTexture || quadsInBatch + count > batchQuads)
+			{
+				++stats.drawCalls;
+				batchOpen = true;
+				quadsInBatch = 0;
+			}
+			currentTexture = texture;
+			quadsInBatch += count;
+			stats.primitives += count;
+			stats.bytes += count * 4 * vertexBytes;
+		}
+		void SetShader(unsigned int shader)
+		{
+			if (shader == currentShader) return;
+			++stats.shaderChanges;
+			currentShader = shader;
+			batchOpen = false; // rlgl flushes on any shader change
+		}
+
+		static rl::Color Blend(rl::Color dst, rl::Color src)
+		{
+			int a = src.a;
+			auto mix = [a](unsigned char d, unsigned char s) { return (unsigned char)((s * a + d * (255 - a) + 127) / 255); };
+			return { mix(dst.r, src.r), mix(dst.g, src.g), mix(dst.b, src.b), (unsigned char)std::min(255, a + dst.a * (255 - a) / 255) };
+		}
+		static rl::Color Modulate(rl::Color a, rl::Color b)
+		{
+			return { (unsigned char)(a.r * b.r / 255), (unsigned char)(a.g * b.g / 255), (unsigned char)(a.b * b.b / 255), (unsigned char)(a.a * b.a / 255) };
+		}
+
+		// Pixels whose centers are inside [start, start + size), clipped to [0, limit)
+		static void Span(float start, float size, int limit, int& first, int& last)
+		{
+			first = std::max(0, (int)std::ceil(start - 0.5f));
+			last = std::min(limit, (int)std::ceil(start + size - 0.5f));
+		}
+
+		void FillRect(rl::Rectangle rect, rl::Color color)
+		{
+			if (!width || color.a == 0) return;
+			int x0, x1, y0, y1;
+			Span(rect.x, rect.width, width, x0, x1);
+			Span(rect.y, rect.height, height, y0, y1);
+			for (int y = y0; y < y1; ++y)
+			{
+				rl::Color* row = &pixels[(size_t)y * width];
+				for (int x = x0; x < x1; ++x)
+				{
+					row[x] = Blend(row[x], color);
+				}
+			}
+		}
+
+		void FillTexture(unsigned int texture, rl::Rectangle source, rl::Rectangle dest, rl::Color tint)
+		{
+			if (!width || tint.a == 0 || dest.width <= 0 || dest.height <= 0) return;
+			auto it = textures.find(texture);
+			if (it == textures.end())
+			{
+				FillRect(dest, tint); // Textures without pixels sample as white
+				return;
+			}
+			const TexturePixels& image = it->second;
+
+			// A negative source size flips that axis, as in rl::DrawTexturePro
+			bool flipX = source.width < 0, flipY = source.height < 0;
+			source.width = std::abs(source.width);
+			source.height = std::abs(source.height);
+
+			int x0, x1, y0, y1;
+			Span(dest.x, dest.width, width, x0, x1);
+			Span(dest.y, dest.height, height, y0, y1);
+			for (int y = y0; y < y1; ++y)
+			{
+				float v = ((float)y + 0.5f - dest.y) / dest.height;
+				if (flipY) v = 1 - v;
+				int ty = (int)std::floor(source.y + v * source.height) % image.height;
+				if (ty < 0) ty += image.height; // Repeat wrapping
+				rl::Color* row = &pixels[(size_t)y * width];
+				for (int x = x0; x < x1; ++x)
+				{
+					float u = ((float)x + 0.5f - dest.x) / dest.width;
+					if (flipX) u = 1 - u;
+					int tx = (int)std::floor(source.x + u * source.width) % image.width;
+					if (tx < 0) tx += image.width;
+					row[x] = Blend(row[x], Modulate(image.pixels[(size_t)ty * image.width + tx], tint));
+				}
+			}
+		}
+
+	public:
+		// Starts counting a new frame. Like rlgl, the texture and shader carry over from the last one.
+		void BeginFrame()
+		{
+			stats = {};
+			batchOpen = false;
+		}
+		const FrameStats& GetFrameStats() const { return stats; }
+
+		// Rasterizes draws into a width x height image from now on; 0 stops rasterizing
+		void SetTarget(int width, int height)
+		{
+			this->width = std::max(width, 0);
+			this->height = this->width ? std::max(height, 0) : 0;
+			pixels.assign((size_t)this->width * this->height, rl::Color{ 0,0,0,0 });
+		}
+		void ClearTarget(rl::Color color) { std::fill(pixels.begin(), pixels.end(), color); }
+		int GetTargetWidth() const { return width; }
+		int GetTargetHeight() const { return height; }
+		// Row-major, top row first
+		const std::vector<rl::Color>& GetPixels() const { return pixels; }
+		// A view of the raster target, e.g. for rl::ExportImage. Don't unload it.
+		rl::Image GetImage()
+		{
+			return { pixels.data(), width, height, 1, rl::PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+		}
+
+		// Gives texture pixels to sample when rasterizing (texture.width * texture.height, top row first)
+		void SetTexturePixels(rl::Texture texture, _In_reads_(texture.width * texture.height) const rl::Color* data)
+		{
+			TexturePixels& image = textures[texture.id];
+			image.width = texture.width;
+			image.height = texture.height;
+			image.pixels.assign(data, data + (size_t)texture.width * texture.height);
+		}
+
+		void SetShapesTexture(rl::Texture texture, rl::Rectangle) override { shapesTexture = texture.id; }
+		void BeginShaderMode(rl::Shader shader) override { SetShader(shader.id); }
+		void EndShaderMode() override { SetShader(0); }
+
+		void DrawRectangle(rl::Rectangle rect, rl::Color color) override
+		{
+			AddQuads(shapesTexture, 1);
+			FillRect(rect, color);
+		}
+		// Same four quads as rl::DrawRectangleLinesEx
+		void DrawRectangleLines(rl::Rectangle rect, float lineThick, rl::Color color) override
+		{
+			AddQuads(shapesTexture, 4);
+			if (!width) return;
+			if (lineThick > rect.width || lineThick > rect.height)
+			{
+				lineThick = std::min(rect.width, rect.height) / 2;
+			}
+			FillRect({ rect.x, rect.y, rect.width, lineThick }, color);
+			FillRect({ rect.x, rect.y - lineThick + rect.height, rect.width, lineThick }, color);
+			FillRect({ rect.x, rect.y + lineThick, lineThick, rect.height - lineThick * 2 }, color);
+			FillRect({ rect.x - lineThick + rect.width, rect.y + lineThick, lineThick, rect.height - lineThick * 2 }, color);
+		}
+		void DrawTexture(rl::Texture texture, rl::Rectangle source, rl::Rectangle dest, rl::Color tint) override
+		{
+			AddQuads(texture.id, 1);
+			FillTexture(texture.id, source, dest, tint);
+		}
+	};
+
+	/*************************************************************
+	* Stands in for raylib's default font when there is no window
+	* to load it, e.g. TextCache::SetDefaultFont with a
+	* HeadlessDrawSink. Printable ASCII, fixed width, sized like
+	* the default font. It has no pixels; glyphs rasterize as
+	* solid boxes unless given some with SetTexturePixels.
+	*************************************************************/
+	class HeadlessFont
+	{
+	private:
+		static constexpr int firstChar = 32, charCount = 95, columns = 16;
+
+		std::vector<rl::Rectangle> recs;
+		std::vector<rl::GlyphInfo> glyphs;
+		rl::Font font = {};
+
+	public:
+		// textureId: Any id no real texture uses, so the font gets its own batches
+		HeadlessFont(unsigned int textureId, int baseSize = 10) : recs(charCount), glyphs(charCount)
+		{
+			int glyphWidth = baseSize / 2 + 1;
+			for (int i = 0; i < charCount; ++i)
+			{
+				recs[i] = { (float)(i % columns * glyphWidth), (float)(i / columns * baseSize), (float)glyphWidth, (float)baseSize };
+				glyphs[i] = {};
+				glyphs[i].value = firstChar + i;
+			}
+			font.baseSize = baseSize;
+			font.glyphCount = charCount;
+			font.glyphPadding = 0;
+			font.texture = { textureId, columns * glyphWidth, (charCount + columns - 1) / columns * baseSize, 1, rl::PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+			font.recs = recs.data();
+			font.glyphs = glyphs.data();
+		}
+		HeadlessFont(const HeadlessFont&) = delete;
+		HeadlessFont& operator=(const HeadlessFont&) = delete;
+
+		rl::Font GetFont() const { return font; }
+	};
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "EditorUI.h"
+
+namespace EditorUI
+{
+	/*************************************************************
+	* Uniform grid of every pane's hover regions, for finding the
+	* topmost region under the mouse without testing every pane.
+	*
+	* Add panes back to front (in draw order). Each region is
+	* filed under every cell it touches, so a hit-test only has
+	* to look through the few regions in the cursor's cell.
+	*************************************************************/
+	class HitGrid
+	{
+	public:
+		struct Hit
+		{
+			int owner = -1; // As passed to AddPane
+			Pane::HoverRegion region = Pane::HoverRegion::notHovering;
+
+			explicit operator bool() const { return owner >= 0; }
+		};
+
+	private:
+		struct Entry
+		{
+			rl::Rectangle rect;
+			int owner;
+			Pane::HoverRegion region;
+			uint32_t order; // Higher is on top
+		};
+
+		float cellSize;
+		std::vector<Entry> entries;
+		std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+		uint32_t paneCount = 0;
+
+		int CellCoord(float value) const { return (int)std::floor(value / cellSize); }
+		static uint64_t CellKey(int x, int y) { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y; }
+
+		// Same rule as rl::CheckCollisionPointRec
+		static bool Contains(const rl::Rectangle& rect, rl::Vector2 point)
+		{
+			return point.x >= rect.x && point.x < rect.x + rect.width && point.y >= rect.y && point.y < rect.y + rect.height;
+		}
+
+		// priority breaks ties between regions of the same pane, matching the order Pane::CheckHover tests them
+		void AddRegion(rl::Rectangle rect, int owner, Pane::HoverRegion region, uint32_t priority)
+		{
+			if (rect.width <= 0 || rect.height <= 0) return;
+
+			uint32_t index = (uint32_t)entries.size();
+			entries.push_back({ rect, owner, region, (paneCount << 3) | priority });
+
+			int xEnd = CellCoord(rect.x + rect.width);
+			int yEnd = CellCoord(rect.y + rect.height);
+			for (int y = CellCoord(rect.y); y <= yEnd; ++y)
+			{
+				for (int x = CellCoord(rect.x); x <= xEnd; ++x)
+				{
+					cells[CellKey(x, y)].push_back(index);
+				}
+			}
+		}
+
+	public:
+		// cellSize: Roughly the size of a small pane. Smaller cells mean fewer regions per hit-test
+		// but more cells per region.
+		HitGrid(float cellSize = 64) : cellSize(cellSize) {}
+
+		// Empties the grid, keeping its cells' allocations for the next rebuild
+		void Clear()
+		{
+			entries.clear();
+			for (auto& [key, cell] : cells)
+			{
+				cell.clear();
+			}
+			paneCount = 0;
+		}
+
+		// Adds pane above everything added so far
+		void AddPane(const Pane& pane, int owner)
+		{
+			const rl::Rectangle& rect = pane.rect;
+			float right = rect.x + rect.width;
+			float bottom = rect.y + rect.height;
+			float edge = Pane::edgeSize;
+
+			AddRegion(pane.gripRect, owner, Pane::HoverRegion::handle, 4);
+			AddRegion(rect, owner, Pane::HoverRegion::hovering, 3);
+			AddRegion({ right - edge, bottom, edge * 2, edge }, owner, Pane::HoverRegion::corner, 2);
+			AddRegion({ right, rect.y, edge, rect.height + edge }, owner, Pane::HoverRegion::edge_right, 1);
+			AddRegion({ rect.x, bottom, rect.width + edge, edge }, owner, Pane::HoverRegion::edge_bottom, 0);
+			++paneCount;
+		}
+
+		size_t GetPaneCount() const { return paneCount; }
+
+		// The topmost region containing point, if any
+		Hit HitTest(rl::Vector2 point) const
+		{
+			auto it = cells.find(CellKey(CellCoord(point.x), CellCoord(point.y)));
+			if (it == cells.end()) return {};
+
+			const Entry* top = nullptr;
+			for (uint32_t index : it->second)
+			{
+				const Entry& entry = entries[index];
+				if ((!top || entry.order > top->order) && Contains(entry.rect, point)) top = &entry;
+			}
+			if (!top) return {};
+			return { top->owner, top->region };
+		}
+	};
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "Platform.h"
+namespace rl {
+#include <raylib.h>
+}
+
+namespace EditorUI
+{
+	struct InputEvent
+	{
+		enum class Type
+		{
+			mouseMove,
+			mouseDown,
+			mouseUp,
+			mouseWheel,
+			keyDown,
+			keyUp,
+			character,
+			windowResize,
+		};
+
+		Type type;
+		double time;           // Seconds, as rl::GetTime
+		rl::Vector2 position;  // Of the mouse
+		rl::Vector2 delta;     // mouseMove: since the last mouseMove. mouseWheel: scroll amount.
+		int code;              // mouseDown/mouseUp: button. keyDown/keyUp: key. character: codepoint.
+	};
+
+	/*************************************************************
+	* Queue of timestamped input events for the editor to drain.
+	*
+	* raylib only exposes input as state that changes between
+	* polls, so Poll turns each change since the previous Poll
+	* into events. With rl::EnableEventWaiting the main loop
+	* blocks until there is input, so a frame, and its Poll,
+	* happens for every burst of input instead of 60 times a
+	* second. Events can also be pushed directly, e.g. to script
+	* interactions.
+	*************************************************************/
+	class InputQueue
+	{
+	private:
+		std::vector<InputEvent> events;
+		size_t next = 0; // Events before next have been popped
+
+		bool mouseKnown = false;
+		rl::Vector2 mousePosition = {};
+		std::vector<int> keysDown;
+
+	public:
+		void Push(const InputEvent& event) { events.push_back(event); }
+
+		// Queues whatever changed since the previous Poll. Call once per frame, after raylib has polled input.
+		void Poll()
+		{
+			double time = rl::GetTime();
+			rl::Vector2 position = rl::GetMousePosition();
+
+			if (rl::IsWindowResized())
+			{
+				Push({ InputEvent::Type::windowResize, time, position, {}, 0 });
+			}
+
+			if (!mouseKnown || position.x != mousePosition.x || position.y != mousePosition.y)
+			{
+				rl::Vector2 delta = mouseKnown ? rl::Vector2{ position.x - mousePosition.x, position.y - mousePosition.y } : rl::Vector2{};
+				Push({ InputEvent::Type::mouseMove, time, position, delta, 0 });
+				mousePosition = position;
+				mouseKnown = true;
+			}
+
+			// Presses come before releases so a click within one poll isn't seen as a release first
+			for (int button = rl::MOUSE_BUTTON_LEFT; button <= rl::MOUSE_BUTTON_MIDDLE; ++button)
+			{
+				if (rl::IsMouseButtonPressed(button)) Push({ InputEvent::Type::mouseDown, time, position, {}, button });
+			}
+			for (int button = rl::MOUSE_BUTTON_LEFT; button <= rl::MOUSE_BUTTON_MIDDLE; ++button)
+			{
+				if (rl::IsMouseButtonReleased(button)) Push({ InputEvent::Type::mouseUp, time, position, {}, button });
+			}
+
+			rl::Vector2 wheel = rl::GetMouseWheelMoveV();
+			if (wheel.x != 0 || wheel.y != 0)
+			{
+				Push({ InputEvent::Type::mouseWheel, time, position, wheel, 0 });
+			}
+
+			for (int key = rl::GetKeyPressed(); key; key = rl::GetKeyPressed())
+			{
+				Push({ InputEvent::Type::keyDown, time, position, {}, key });
+				if (std::find(keysDown.begin(), keysDown.end(), key) == keysDown.end()) keysDown.push_back(key);
+			}
+			for (auto it = keysDown.begin(); it != keysDown.end();)
+			{
+				if (rl::IsKeyUp(*it))
+				{
+					Push({ InputEvent::Type::keyUp, time, position, {}, *it });
+					it = keysDown.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+			for (int codepoint = rl::GetCharPressed(); codepoint; codepoint = rl::GetCharPressed())
+			{
+				Push({ InputEvent::Type::character, time, position, {}, codepoint });
+			}
+		}
+
+		// Takes the oldest event, if there is one
+		bool Pop(_Out_ InputEvent& event)
+		{
+			if (next == events.size())
+			{
+				// Drained, so the storage can be reused from the start
+				events.clear();
+				next = 0;
+				return false;
+			}
+			event = events[next++];
+			return true;
+		}
+
+		bool IsEmpty() const { return next == events.size(); }
+		size_t GetCount() const { return events.size() - next; }
+
+		void Clear()
+		{
+			events.clear();
+			next = 0;
+		}
+	};
+}
@@ -0,0 +1,317 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <unordered_map>
+#include "EditorUI.h"
+
+namespace EditorUI
+{
+	/***************************************************************
+	* Keeps each pane's pixels in a render texture, so a pane that
+	* hasn't changed is drawn as a single textured quad instead of
+	* being rebuilt.
+	*
+	* Panes share a few large atlas pages rather than having a
+	* texture each, so the quads of every cached pane on a page have
+	* the same material and DrawList draws them in one batch.
+	* Regions are packed into shelves of rows, and a pane keeps its
+	* region while it shrinks or grows within it.
+	*
+	* A pane is redrawn into its region when it is invalidated
+	* (Pane::Invalidate), resized, the theme version changes, or
+	* the window's DPI scale changes.
+	***************************************************************/
+	class PaneCache
+	{
+	public:
+		struct FrameStats
+		{
+			int hits = 0;
+			int misses = 0;
+			int pages = 0; // Atlas pages the cached panes were drawn from
+		};
+
+	private:
+		// Regions are allocated in steps of this many pixels, so resizing doesn't move a pane every frame
+		static constexpr int sizeStep = 32;
+		// Pixels left between regions, so nothing drawn in one can be sampled from its neighbour
+		static constexpr int gutter = 1;
+		// Pages are square; a pane larger than this gets a page of its own size
+		static constexpr int pageSize = 2048;
+
+		// Where a pane's pixels are kept
+		struct Region
+		{
+			int page = -1;
+			int x = 0, y = 0, width = 0, height = 0;
+		};
+
+		struct Span
+		{
+			int x, width;
+			bool free;
+		};
+		// A row of a page, split into spans along x
+		struct Shelf
+		{
+			int y, height;
+			std::vector<Span> spans;
+		};
+		struct Page
+		{
+			rl::RenderTexture2D target = {};
+			int width = 0, height = 0;
+			std::vector<Shelf> shelves;
+			int shelvesHeight = 0; // Rows taken by shelves, from the top
+			int regions = 0;
+		};
+
+		struct Entry
+		{
+			Region region;
+			int width = 0, height = 0; // Pixels of the region the pane covers
+			float scale = 0;
+			unsigned int contentVersion = 0;
+			unsigned int themeVersion = 0;
+			bool used = false;
+		};
+
+		std::unordered_map<const Pane*, Entry> entries;
+		std::vector<Page> pages; // Unloaded pages keep their place, so regions can refer to pages by index
+		DrawList drawList; // For drawing into the pages
+		FrameStats stats;
+
+		static int RoundUpToStep(int value) { return (value + sizeStep - 1) / sizeStep * sizeStep; }
+
+		// Takes width from the first free span of shelf wide enough, if any
+		static bool AllocateFromShelf(Shelf& shelf, int width, Region& region)
+		{
+			for (size_t i = 0; i < shelf.spans.size(); ++i)
+			{
+				Span& span = shelf.spans[i];
+				if (!span.free || span.width < width) continue;
+				region.x = span.x;
+				region.y = shelf.y;
+				region.width = width;
+				region.height = shelf.height;
+				if (span.width > width) shelf.spans.insert(shelf.spans.begin() + i + 1, Span{ span.x + width, span.width - width, true });
+				shelf.spans[i] = { region.x, width, false };
+				return true;
+			}
+			return false;
+		}
+
+		bool AllocateFromPage(Page& page, int width, int height, Region& region)
+		{
+			if (!page.target.id || width > page.width || height > page.height) return false;
+			for (Shelf& shelf : page.shelves)
+			{
+				// Shelves much taller than the region would waste most of the space taken from them
+				if (shelf.height < height || shelf.height > height * 2) continue;
+				if (AllocateFromShelf(shelf, width, region)) return true;
+			}
+			if (page.shelvesHeight + height > page.height) return false;
+			page.shelves.push_back({ page.shelvesHeight, height, { Span{ 0, page.width, true } } });
+			page.shelvesHeight += height;
+			return AllocateFromShelf(page.shelves.back(), width, region);
+		}
+
+		Region Allocate(int width, int height)
+		{
+			Region region;
+			for (size_t i = 0; i < pages.size(); ++i)
+			{
+				if (!AllocateFromPage(pages[i], width, height, region)) continue;
+				region.page = (int)i;
+				++pages[i].regions;
+				return region;
+			}
+
+			size_t index = 0;
+			while (index < pages.size() && pages[index].target.id) ++index;
+			if (index == pages.size()) pages.emplace_back();
+			Page& page = pages[index];
+			page = {};
+			page.width = std::max(pageSize, width);
+			page.height = std::max(pageSize, height);
+			page.target = rl::LoadRenderTexture(page.width, page.height);
+			bool allocated = AllocateFromPage(page, width, height, region);
+			_ASSERT_EXPR(allocated, L"A new page must fit the region it was made for");
+			region.page = (int)index;
+			++page.regions;
+			return region;
+		}
+
+		// Returns region's space to its page. Pages left empty are unloaded by BeginFrame,
+		// so a pane that is resized alone on its page doesn't reload it.
+		void Free(Region& region)
+		{
+			if (region.page < 0) return;
+			Page& page = pages[region.page];
+			auto shelf = std::find_if(page.shelves.begin(), page.shelves.end(), [&](const Shelf& s) { return s.y == region.y; });
+			_ASSERT_EXPR(shelf != page.shelves.end(), L"Region is not in its page");
+			std::vector<Span>& spans = shelf->spans;
+			auto span = std::find_if(spans.begin(), spans.end(), [&](const Span& s) { return s.x == region.x; });
+			_ASSERT_EXPR(span != spans.end() && !span->free, L"Region is not in its shelf");
+			span->free = true;
+			// Merge with free neighbours
+			if (span + 1 != spans.end() && (span + 1)->free)
+			{
+				span->width += (span + 1)->width;
+				spans.erase(span + 1);
+			}
+			if (span != spans.begin() && (span - 1)->free)
+			{
+				(span - 1)->width += span->width;
+				spans.erase(span);
+			}
+			// Empty shelves at the bottom give their rows back, so they can be reused at another height
+			while (!page.shelves.empty() && page.shelves.back().spans.size() == 1 && page.shelves.back().spans[0].free)
+			{
+				page.shelvesHeight -= page.shelves.back().height;
+				page.shelves.pop_back();
+			}
+			--page.regions;
+			region = {};
+		}
+
+		void Render(const Pane& pane, Entry& entry, float scale)
+		{
+			int width = (int)std::ceil(pane.rect.width * scale);
+			int height = (int)std::ceil(pane.rect.height * scale);
+			if (entry.region.page < 0 || width + gutter > entry.region.width || height + gutter > entry.region.height)
+			{
+				Free(entry.region);
+				entry.region = Allocate(RoundUpToStep(width + gutter), RoundUpToStep(height + gutter));
+			}
+			entry.width = width;
+			entry.height = height;
+			entry.scale = scale;
+			entry.contentVersion = pane.contentVersion;
+			entry.themeVersion = Theme::version;
+
+			// The pane draws itself at its screen position; the camera moves that to the region
+			const Region& region = entry.region;
+			rl::Camera2D camera = {};
+			camera.offset = { (float)region.x, (float)region.y };
+			camera.target = { pane.rect.x, pane.rect.y };
+			camera.zoom = scale;
+
+			// The scissor keeps the clear, and anything the pane draws outside its rect, out of other regions
+			rl::BeginTextureMode(pages[region.page].target);
+			rl::BeginScissorMode(region.x, region.y, region.width, region.height);
+			rl::ClearBackground(rl::BLANK);
+			rl::BeginMode2D(camera);
+			pane.Draw(drawList);
+			drawList.Submit();
+			rl::EndMode2D();
+			rl::EndScissorMode();
+			rl::EndTextureMode();
+		}
+
+		void UnloadEmptyPages()
+		{
+			for (Page& page : pages)
+			{
+				if (!page.target.id || page.regions) continue;
+				rl::UnloadRenderTexture(page.target);
+				page = {};
+			}
+		}
+
+	public:
+		PaneCache() = default;
+		PaneCache(const PaneCache&) = delete;
+		PaneCache& operator=(const PaneCache&) = delete;
+		~PaneCache() { Clear(); }
+
+		// Shares the main list's shapes texture, so cached panes look the same as live ones
+		void SetShapesTexture(rl::Texture texture, rl::Rectangle source) { drawList.SetShapesTexture(texture, source); }
+
+		// Call once per frame, before drawing any panes.
+		// Frees the regions of panes that weren't drawn last frame, and pages left empty.
+		void BeginFrame()
+		{
+			for (auto it = entries.begin(); it != entries.end();)
+			{
+				if (!it->second.used)
+				{
+					Free(it->second.region);
+					it = entries.erase(it);
+				}
+				else
+				{
+					it->second.used = false;
+					++it;
+				}
+			}
+			UnloadEmptyPages();
+			stats = {};
+		}
+
+		// Redraws pane's region if it is out of date, then adds it to the list as one quad.
+		// Must be called before the list is submitted.
+		void Draw(DrawList& target, const Pane& pane)
+		{
+			Entry& entry = entries[&pane];
+			entry.used = true;
+
+			float scale = rl::GetWindowScaleDPI().x;
+			int width = (int)std::ceil(pane.rect.width * scale);
+			int height = (int)std::ceil(pane.rect.height * scale);
+			bool valid =
+				entry.region.page >= 0 &&
+				entry.width == width &&
+				entry.height == height &&
+				entry.scale == scale &&
+				entry.contentVersion == pane.contentVersion &&
+				entry.themeVersion == Theme::version;
+
+			if (valid)
+			{
+				++stats.hits;
+			}
+			else
+			{
+				++stats.misses;
+				Render(pane, entry, scale);
+			}
+
+			// Render textures are stored bottom row first, so the region is measured from the bottom, upside down
+			const rl::Texture& texture = pages[entry.region.page].target.texture;
+			rl::Rectangle source = { (float)entry.region.x, (float)(texture.height - entry.region.y - entry.height), (float)entry.width, -(float)entry.height };
+			target.DrawTexture(texture, source, pane.rect, rl::WHITE);
+		}
+
+		// Frees pane's region, e.g. when the pane is destroyed
+		void Evict(const Pane& pane)
+		{
+			auto it = entries.find(&pane);
+			if (it == entries.end()) return;
+			Free(it->second.region);
+			entries.erase(it);
+		}
+		void Clear()
+		{
+			entries.clear();
+			for (Page& page : pages)
+			{
+				if (page.target.id) rl::UnloadRenderTexture(page.target);
+			}
+			pages.clear();
+		}
+
+		// Hits and misses since BeginFrame, and the pages in use
+		FrameStats GetFrameStats() const
+		{
+			FrameStats frame = stats;
+			for (const Page& page : pages)
+			{
+				frame.pages += !!page.target.id;
+			}
+			return frame;
+		}
+		size_t GetCachedCount() const { return entries.size(); }
+	};
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "EditorUI.h"
+#include "Engine.Profiler.h"
+
+namespace EditorUI
+{
+	/*************************************************************
+	* Pane content showing Engine::Profiler's results: a graph of
+	* recent frame times against a 60 fps budget, and the time
+	* each profiled scope took, smoothed over the last frames.
+	*
+	* Call Update once per frame, after Profiler::EndFrame, and
+	* invalidate the pane it is in so it gets redrawn.
+	*************************************************************/
+	class ProfilerView : public IPaneContent
+	{
+	public:
+		static constexpr float graphHeight = 60;
+		static constexpr float barWidth = 2;
+		// Frame time at the top of the graph; the line across it is half of this
+		static constexpr double graphMilliseconds = 1000.0 / 30;
+		// Weight of the newest frame in the smoothed times
+		static constexpr double smoothing = 0.1;
+
+	private:
+		struct Row
+		{
+			const char* name;
+			double milliseconds; // Smoothed
+			uint32_t calls;      // Last frame
+			uint32_t depth;
+			bool seen;           // In the last frame
+		};
+
+		std::vector<Row> rows;
+		double frameMilliseconds = 0; // Smoothed
+
+		static float RowHeight() { return (float)(Theme::fontSize + 4); }
+
+		// Draws text, returning the x after it. Values change every frame; textCache evicts the old ones.
+		static int DrawString(DrawList& drawList, std::string_view text, int x, int y, rl::Color color)
+		{
+			const TextRun& run = textCache.Get(text, Theme::fontSize);
+			drawList.DrawText(run, x, y, color);
+			return x + (int)run.width;
+		}
+		static int DrawMilliseconds(DrawList& drawList, double milliseconds, int x, int y, rl::Color color)
+		{
+			char text[32];
+			int length = std::snprintf(text, sizeof(text), "%.3f ms", milliseconds);
+			return DrawString(drawList, std::string_view(text, (size_t)std::max(length, 0)), x, y, color);
+		}
+
+	public:
+		// Takes in the frame Profiler::EndFrame just closed
+		void Update()
+		{
+			if (Engine::Profiler::GetFrameCount())
+			{
+				double last = (double)Engine::Profiler::GetFrame(0).nanoseconds / 1e6;
+				frameMilliseconds = frameMilliseconds ? frameMilliseconds + (last - frameMilliseconds) * smoothing : last;
+			}
+
+			for (Row& row : rows)
+			{
+				row.seen = false;
+			}
+			const std::vector<Engine::Profiler::ScopeTotal>& totals = Engine::Profiler::GetLastFrame();
+			std::vector<Row> ordered;
+			ordered.reserve(std::max(totals.size(), rows.size()));
+			for (const Engine::Profiler::ScopeTotal& total : totals)
+			{
+				double milliseconds = (double)total.nanoseconds / 1e6;
+				auto it = std::find_if(rows.begin(), rows.end(), [&](const Row& row) { return std::strcmp(row.name, total.name) == 0; });
+				if (it == rows.end())
+				{
+					ordered.push_back({ total.name, milliseconds, total.calls, total.depth, true });
+				}
+				else
+				{
+					it->seen = true;
+					ordered.push_back({ it->name, it->milliseconds + (milliseconds - it->milliseconds) * smoothing, total.calls, total.depth, true });
+				}
+			}
+			// Scopes that didn't run this frame decay towards zero, after the ones that did
+			for (const Row& row : rows)
+			{
+				if (!row.seen) ordered.push_back({ row.name, row.milliseconds * (1 - smoothing), 0, row.depth, false });
+			}
+			rows = std::move(ordered);
+		}
+
+		void Clear()
+		{
+			rows.clear();
+			frameMilliseconds = 0;
+		}
+
+		void Draw(DrawList& drawList, rl::Rectangle area) override
+		{
+			// Newest frame on the right, as many as fit
+			rl::Rectangle graph = { area.x, area.y, area.width, std::min(graphHeight, area.height) };
+			drawList.DrawRectangle(graph, Theme::color_body);
+			size_t frames = std::min({ Engine::Profiler::GetFrameCount(), Engine::Profiler::GetHistorySize(), (size_t)(graph.width / barWidth) });
+			for (size_t i = 0; i < frames; ++i)
+			{
+				double milliseconds = (double)Engine::Profiler::GetFrame(i).nanoseconds / 1e6;
+				float height = (float)std::min(milliseconds / graphMilliseconds, 1.0) * graph.height;
+				rl::Color color = milliseconds * 2 > graphMilliseconds ? Theme::color_highlight : Theme::color_foreground;
+				drawList.DrawRectangle({ graph.x + graph.width - (float)(i + 1) * barWidth, graph.y + graph.height - height, barWidth, height }, color);
+			}
+			drawList.DrawRectangle({ graph.x, graph.y + graph.height / 2, graph.width, 1 }, Theme::color_accent);
+
+			float rowHeight = RowHeight();
+			int valueX = (int)(area.x + area.width * 0.6f);
+			float y = graph.y + graph.height + 2;
+			if (y + rowHeight <= area.y + area.height)
+			{
+				drawList.DrawText(textCache.Get("Frame", Theme::fontSize), (int)area.x + 4, (int)y, Theme::color_foreground);
+				DrawMilliseconds(drawList, frameMilliseconds, valueX, (int)y, Theme::color_foreground);
+				y += rowHeight;
+			}
+			for (const Row& row : rows)
+			{
+				if (y + rowHeight > area.y + area.height) break;
+				rl::Color color = row.seen ? Theme::color_foreground : Theme::color_accent;
+				int x = (int)area.x + 4 + (int)(row.depth + 1) * 8;
+				drawList.DrawText(textCache.Get(row.name, Theme::fontSize), x, (int)y, color);
+				x = DrawMilliseconds(drawList, row.milliseconds, valueX, (int)y, color);
+				if (row.calls > 1)
+				{
+					char calls[16];
+					int length = std::snprintf(calls, sizeof(calls), " x%u", row.calls);
+					DrawString(drawList, std::string_view(calls, (size_t)std::max(length, 0)), x, (int)y, color);
+				}
+				y += rowHeight;
+			}
+		}
+
+		bool HandleEvent(const InputEvent& event, rl::Rectangle area) override
+		{
+			// Clicking the graph pauses or resumes recording
+			if (event.type != InputEvent::Type::mouseDown || event.code != rl::MOUSE_LEFT_BUTTON) return false;
+			if (!rl::CheckCollisionPointRec(event.position, { area.x, area.y, area.width, std::min(graphHeight, area.height) })) return false;
+			Engine::Profiler::SetEnabled(!Engine::Profiler::IsEnabled());
+			return true;
+		}
+	};
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Platform.h"
+namespace rl {
+#include <raylib.h>
+}
+
+namespace EditorUI
+{
+	// A laid-out string: its size, and a quad per visible glyph relative to where it is drawn
+	struct TextRun
+	{
+		struct Glyph
+		{
+			rl::Rectangle source; // In the font's texture
+			rl::Rectangle dest;   // Offset from the run's position
+		};
+
+		rl::Font font;
+		int fontSize;
+		float width;  // As rl::MeasureTextEx
+		float height;
+		std::vector<Glyph> glyphs;
+	};
+
+	/***************************************************************
+	* Measures and lays out each distinct (text, font, size) once.
+	*
+	* Layout follows rl::DrawTextEx and rl::MeasureTextEx, with the
+	* spacing rl::DrawText uses for the default font. Looking up
+	* text that was laid out before is a single hash lookup.
+	*
+	* Runs stay valid until Clear or until EvictUnused drops them,
+	* so they can be referenced by a DrawList until it is submitted.
+	* EvictUnused, called once a frame, drops runs that haven't been
+	* drawn for a while, so text that is only shown briefly (scrolled
+	* rows, changing numbers) doesn't pile up.
+	***************************************************************/
+	class TextCache
+	{
+	private:
+		// Gap between lines, as raylib's default textLineSpacing
+		static constexpr int lineSpacing = 2;
+
+		struct Key
+		{
+			std::string text;
+			unsigned int fontTexture;
+			int fontSize;
+			float spacing;
+		};
+		// Lets lookups use a string_view without building a Key's string
+		struct KeyView
+		{
+			std::string_view text;
+			unsigned int fontTexture;
+			int fontSize;
+			float spacing;
+		};
+		struct KeyHash
+		{
+			using is_transparent = void;
+			size_t operator()(const KeyView& key) const
+			{
+				size_t hash = std::hash<std::string_view>()(key.text);
+				hash ^= ((size_t)key.fontTexture * 0x9E3779B97F4A7C15ull) + (size_t)key.fontSize + ((size_t)key.spacing << 16);
+				return hash;
+			}
+			size_t operator()(const Key& key) const { return (*this)(KeyView{ key.text, key.fontTexture, key.fontSize, key.spacing }); }
+		};
+		struct KeyEqual
+		{
+			using is_transparent = void;
+			static KeyView View(const Key& key) { return { key.text, key.fontTexture, key.fontSize, key.spacing }; }
+			static const KeyView& View(const KeyView& key) { return key; }
+			template<class _A, class _B>
+			bool operator()(const _A& a, const _B& b) const
+			{
+				const KeyView& x = View(a);
+				const KeyView& y = View(b);
+				return x.fontTexture == y.fontTexture && x.fontSize == y.fontSize && x.spacing == y.spacing && x.text == y.text;
+			}
+		};
+
+		struct Entry
+		{
+			TextRun run;
+			uint64_t lastUsedFrame;
+			std::list<const Key*>::iterator use; // In recent
+		};
+
+		std::unordered_map<Key, Entry, KeyHash, KeyEqual> runs;
+		// Keys of runs, most recently used first, so eviction only visits what it drops
+		std::list<const Key*> recent;
+		uint64_t frame = 0; // EvictUnused calls so far
+		size_t hits = 0, misses = 0, evictions = 0;
+		rl::Font defaultFont = {}; // Unset uses rl::GetFontDefault
+
+		static TextRun Layout(std::string_view text, rl::Font font, int fontSize, float spacing)
+		{
+			TextRun run = { font, fontSize, 0, (float)fontSize, {} };
+			float scale = (float)fontSize / (float)font.baseSize;
+			float padding = (float)font.glyphPadding;
+
+			std::string terminated(text); // GetCodepoint reads up to 4 bytes ahead
+			float x = 0, y = 0;
+			// MeasureTextEx takes the widest line and the most codepoints on any line separately
+			float lineWidth = 0, maxLineWidth = 0; // Unscaled
+			int lineCount = 0, maxLineCount = 0;
+			for (size_t i = 0; i < terminated.size();)
+			{
+				int bytes = 0;
+				int codepoint = rl::GetCodepoint(terminated.c_str() + i, &bytes);
+				int index = rl::GetGlyphIndex(font, codepoint);
+				if (codepoint == 0x3f) bytes = 1; // '?' is also what GetCodepoint returns for bad UTF-8
+				i += bytes;
+
+				if (codepoint == '\n')
+				{
+					maxLineWidth = std::max(maxLineWidth, lineWidth);
+					lineWidth = 0;
+					lineCount = 0;
+					x = 0;
+					y += (float)(fontSize + lineSpacing);
+					run.height += (float)(fontSize + lineSpacing);
+					continue;
+				}
+
+				const rl::Rectangle& rec = font.recs[index];
+				const rl::GlyphInfo& glyph = font.glyphs[index];
+				if (codepoint != ' ' && codepoint != '\t')
+				{
+					run.glyphs.push_back({
+						{ rec.x - padding, rec.y - padding, rec.width + 2 * padding, rec.height + 2 * padding },
+						{
+							x + (glyph.offsetX - padding) * scale,
+							y + (glyph.offsetY - padding) * scale,
+							(rec.width + 2 * padding) * scale,
+							(rec.height + 2 * padding) * scale
+						},
+					});
+				}
+
+				lineWidth += glyph.advanceX ? (float)glyph.advanceX : rec.width + (float)glyph.offsetX;
+				maxLineCount = std::max(maxLineCount, ++lineCount);
+				x += (glyph.advanceX ? (float)glyph.advanceX : rec.width) * scale + spacing;
+			}
+			maxLineWidth = std::max(maxLineWidth, lineWidth);
+			if (maxLineCount > 0) run.width = maxLineWidth * scale + (float)(maxLineCount - 1) * spacing;
+			return run;
+		}
+
+	public:
+		// Text drawn with the default font, as rl::DrawText
+		const TextRun& Get(std::string_view text, int fontSize)
+		{
+			constexpr int defaultFontSize = 10;
+			int spacingSize = std::max(fontSize, defaultFontSize);
+			rl::Font font = defaultFont.texture.id ? defaultFont : rl::GetFontDefault();
+			return Get(text, font, fontSize, (float)(spacingSize / defaultFontSize));
+		}
+		// Text as drawn by rl::DrawTextEx
+		const TextRun& Get(std::string_view text, rl::Font font, int fontSize, float spacing)
+		{
+			auto it = runs.find(KeyView{ text, font.texture.id, fontSize, spacing });
+			if (it != runs.end())
+			{
+				++hits;
+				Entry& entry = it->second;
+				if (entry.lastUsedFrame != frame)
+				{
+					entry.lastUsedFrame = frame;
+					recent.splice(recent.begin(), recent, entry.use);
+				}
+				return entry.run;
+			}
+			++misses;
+			Key key = { std::string(text), font.texture.id, fontSize, spacing };
+			auto created = runs.emplace(std::move(key), Entry{ Layout(text, font, fontSize, spacing), frame, {} }).first;
+			recent.push_front(&created->first);
+			created->second.use = recent.begin();
+			return created->second.run;
+		}
+
+		float MeasureText(std::string_view text, int fontSize) { return Get(text, fontSize).width; }
+
+		// Replaces raylib's default font, which only exists once a window is open.
+		// font must outlive the cache's runs.
+		void SetDefaultFont(rl::Font font) { defaultFont = font; }
+
+		size_t GetCount() const { return runs.size(); }
+		size_t GetHitCount() const { return hits; }
+		size_t GetMissCount() const { return misses; }
+		size_t GetEvictionCount() const { return evictions; }
+
+		// Drops runs not used in the last maxAge frames, invalidating them, and starts a new frame.
+		// Call once per frame, after the frame's DrawLists are submitted.
+		void EvictUnused(uint64_t maxAge)
+		{
+			while (!recent.empty())
+			{
+				auto it = runs.find(*recent.back());
+				if (frame - it->second.lastUsedFrame < maxAge) break;
+				recent.pop_back();
+				runs.erase(it);
+				++evictions;
+			}
+			++frame;
+		}
+
+		// Invalidates every TextRun handed out so far
+		void Clear()
+		{
+			runs.clear();
+			recent.clear();
+			hits = 0;
+			misses = 0;
+			evictions = 0;
+		}
+	};
+}
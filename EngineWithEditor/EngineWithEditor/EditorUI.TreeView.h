@@ -0,0 +1,283 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "EditorUI.h"
+
+namespace EditorUI
+{
+	/*************************************************************
+	* A scrollable tree of labels, such as a scene hierarchy, that
+	* only lays out and draws the rows that are on screen.
+	*
+	* Nodes are stored in depth-first order, so a node's subtree
+	* is the range that follows it. Whether each node is a visible
+	* row (every ancestor expanded) is kept in a Fenwick tree, so
+	* finding the node at any scroll position, or the row of any
+	* node, is O(log n). Expanding or collapsing a node costs one
+	* update per row it shows or hides.
+	*
+	* Leave out anything that shouldn't be listed (e.g. objects
+	* with HideFlags::HideInHierarchy) when adding nodes.
+	*************************************************************/
+	class TreeView : public IPaneContent
+	{
+	public:
+		using NodeId = uint32_t;
+		static constexpr NodeId none = UINT32_MAX;
+
+		// Horizontal offset per level of depth, which is also the width of the expander
+		static constexpr float indentSize = 12;
+
+	private:
+		struct Node
+		{
+			NodeId parent;
+			uint32_t subtreeSize; // Including the node itself
+			uint16_t depth;
+			bool expanded;
+			bool visible;
+		};
+
+		std::vector<Node> nodes;
+		std::vector<std::string> labels;
+		std::vector<int> rowTree; // Fenwick tree over nodes (1-based) of whether each is a visible row
+		size_t scrollRow = 0;     // First row shown
+		NodeId selected = none;
+		size_t lastDrawnRows = 0;
+
+		static float RowHeight() { return (float)(Theme::fontSize + 4); }
+		static size_t LowBit(size_t i) { return i & (~i + 1); }
+
+		// Visible rows among the first count nodes
+		size_t RowsBefore(size_t count) const
+		{
+			size_t sum = 0;
+			for (size_t i = count; i > 0; i -= LowBit(i))
+			{
+				sum += rowTree[i];
+			}
+			return sum;
+		}
+		void AddRow(size_t node, int delta)
+		{
+			for (size_t i = node + 1; i < rowTree.size(); i += LowBit(i))
+			{
+				rowTree[i] += delta;
+			}
+		}
+		// Builds the Fenwick tree from each node's visible flag in O(n)
+		void RebuildRows()
+		{
+			rowTree.assign(nodes.size() + 1, 0);
+			for (size_t i = 1; i < rowTree.size(); ++i)
+			{
+				rowTree[i] += nodes[i - 1].visible;
+				size_t up = i + LowBit(i);
+				if (up < rowTree.size()) rowTree[up] += rowTree[i];
+			}
+		}
+
+		void SetVisible(NodeId node, bool visible, bool updateRows)
+		{
+			if (nodes[node].visible == visible) return;
+			nodes[node].visible = visible;
+			if (updateRows) AddRow(node, visible ? 1 : -1);
+		}
+		// Shows or hides the rows below node that are reachable through expanded nodes
+		void SetDescendantsVisible(NodeId node, bool visible)
+		{
+			NodeId end = node + nodes[node].subtreeSize;
+			// Rebuilding is cheaper than one update each once a good part of the tree changes
+			bool updateRows = nodes[node].subtreeSize < nodes.size() / 8;
+			for (NodeId i = node + 1; i < end;)
+			{
+				SetVisible(i, visible, updateRows);
+				i += nodes[i].expanded ? 1 : nodes[i].subtreeSize;
+			}
+			if (!updateRows) RebuildRows();
+		}
+
+		size_t RowsPerPage(rl::Rectangle area) const { return (size_t)std::max(0.0f, area.height / RowHeight()); }
+		void ClampScroll(rl::Rectangle area)
+		{
+			size_t rows = GetRowCount(), page = RowsPerPage(area);
+			scrollRow = rows > page ? std::min(scrollRow, rows - page) : 0;
+		}
+
+	public:
+		// Adds a node as the last child of parent, or at the top level.
+		// Nodes must be added depth-first: parent must be the last node added or one of its ancestors.
+		NodeId AddNode(std::string label, NodeId parent = none)
+		{
+			NodeId id = (NodeId)nodes.size();
+			_ASSERT_EXPR(parent == none || (parent < id && parent + nodes[parent].subtreeSize == id),
+				L"Nodes must be added depth-first, after their parent's other descendants");
+
+			bool visible = parent == none || (nodes[parent].visible && nodes[parent].expanded);
+			uint16_t depth = parent == none ? 0 : nodes[parent].depth + 1;
+			nodes.push_back({ parent, 1, depth, false, visible });
+			labels.push_back(std::move(label));
+			for (NodeId ancestor = parent; ancestor != none; ancestor = nodes[ancestor].parent)
+			{
+				++nodes[ancestor].subtreeSize;
+			}
+
+			// Appending to a Fenwick tree: the new entry also covers the LowBit(i) - 1 entries before it
+			if (rowTree.empty()) rowTree.push_back(0); // Index 0 is unused
+			size_t i = rowTree.size();
+			rowTree.push_back((int)visible + (int)(RowsBefore(i - 1) - RowsBefore(i - LowBit(i))));
+			return id;
+		}
+
+		void Clear()
+		{
+			nodes.clear();
+			labels.clear();
+			rowTree.clear();
+			scrollRow = 0;
+			selected = none;
+		}
+
+		size_t GetNodeCount() const { return nodes.size(); }
+		const std::string& GetLabel(NodeId node) const { return labels[node]; }
+		NodeId GetParent(NodeId node) const { return nodes[node].parent; }
+		bool HasChildren(NodeId node) const { return nodes[node].subtreeSize > 1; }
+
+		bool IsExpanded(NodeId node) const { return nodes[node].expanded; }
+		void SetExpanded(NodeId node, bool expanded)
+		{
+			if (nodes[node].expanded == expanded) return;
+			nodes[node].expanded = expanded;
+			if (nodes[node].visible) SetDescendantsVisible(node, expanded);
+		}
+		void ToggleExpanded(NodeId node) { SetExpanded(node, !nodes[node].expanded); }
+
+		// Rows that would be shown with unlimited space
+		size_t GetRowCount() const { return rowTree.empty() ? 0 : RowsBefore(nodes.size()); }
+		// The node shown at row, found in O(log n)
+		NodeId GetNodeAtRow(size_t row) const
+		{
+			if (row >= GetRowCount()) return none;
+			// Descend the Fenwick tree to the last position with at most row visible rows before it
+			size_t position = 0;
+			size_t step = 1;
+			while (step * 2 < rowTree.size()) step *= 2;
+			for (; step > 0; step /= 2)
+			{
+				if (position + step < rowTree.size() && (size_t)rowTree[position + step] <= row)
+				{
+					position += step;
+					row -= rowTree[position];
+				}
+			}
+			return (NodeId)position;
+		}
+		// Row node is shown at, or SIZE_MAX if it is inside a collapsed node
+		size_t GetRowOfNode(NodeId node) const { return nodes[node].visible ? RowsBefore(node) : SIZE_MAX; }
+
+		size_t GetScrollRow() const { return scrollRow; }
+		void ScrollToRow(size_t row) { scrollRow = row; }
+		// Expands node's ancestors and scrolls so it is the first row
+		void ScrollToNode(NodeId node)
+		{
+			for (NodeId ancestor = nodes[node].parent; ancestor != none; ancestor = nodes[ancestor].parent)
+			{
+				SetExpanded(ancestor, true);
+			}
+			scrollRow = GetRowOfNode(node);
+		}
+
+		NodeId GetSelected() const { return selected; }
+		void Select(NodeId node) { selected = node; }
+
+		// Rows drawn by the last Draw
+		size_t GetLastDrawnRowCount() const { return lastDrawnRows; }
+
+		void Draw(DrawList& drawList, rl::Rectangle area) override
+		{
+			ClampScroll(area);
+			float rowHeight = RowHeight();
+			size_t rows = RowsPerPage(area);
+			lastDrawnRows = 0;
+
+			// Only the first row needs a search; the rest follow in depth-first order, skipping collapsed subtrees
+			NodeId node = GetNodeAtRow(scrollRow);
+			for (size_t row = 0; row < rows && node < nodes.size(); ++row)
+			{
+				const Node& info = nodes[node];
+				float y = area.y + (float)row * rowHeight;
+				float x = area.x + 4 + (float)info.depth * indentSize;
+
+				if (node == selected) drawList.DrawRectangle({ area.x, y, area.width, rowHeight }, Theme::color_highlight);
+				if (info.subtreeSize > 1)
+				{
+					const TextRun& expander = textCache.Get(info.expanded ? "-" : "+", Theme::fontSize);
+					drawList.DrawText(expander, (int)x, (int)y + 2, Theme::color_foreground);
+				}
+				const TextRun& label = textCache.Get(labels[node], Theme::fontSize);
+				drawList.DrawText(label, (int)(x + indentSize), (int)y + 2, Theme::color_foreground);
+
+				++lastDrawnRows;
+				node += info.expanded ? 1 : info.subtreeSize;
+			}
+		}
+
+		bool HandleEvent(const InputEvent& event, rl::Rectangle area) override
+		{
+			switch (event.type)
+			{
+			case InputEvent::Type::mouseWheel:
+			{
+				if (!rl::CheckCollisionPointRec(event.position, area) || event.delta.y == 0) return false;
+				size_t before = scrollRow;
+				size_t lines = (size_t)std::max(1.0f, std::abs(event.delta.y) * 3);
+				scrollRow = event.delta.y > 0 ? scrollRow - std::min(scrollRow, lines) : scrollRow + lines;
+				ClampScroll(area);
+				return scrollRow != before;
+			}
+
+			case InputEvent::Type::mouseDown:
+			{
+				if (event.code != rl::MOUSE_LEFT_BUTTON || !rl::CheckCollisionPointRec(event.position, area)) return false;
+				NodeId node = GetNodeAtRow(scrollRow + (size_t)((event.position.y - area.y) / RowHeight()));
+				if (node == none) return false;
+
+				float expanderX = area.x + 4 + (float)nodes[node].depth * indentSize;
+				if (HasChildren(node) && event.position.x >= expanderX && event.position.x < expanderX + indentSize)
+					ToggleExpanded(node);
+				else
+					selected = node;
+				return true;
+			}
+
+			case InputEvent::Type::keyDown:
+			{
+				if (selected == none) return false;
+				size_t row = GetRowOfNode(selected);
+				if (row == SIZE_MAX) return false;
+
+				switch (event.code)
+				{
+				case rl::KEY_UP:    if (row > 0) selected = GetNodeAtRow(row - 1); break;
+				case rl::KEY_DOWN:  if (row + 1 < GetRowCount()) selected = GetNodeAtRow(row + 1); break;
+				case rl::KEY_RIGHT: SetExpanded(selected, true); break;
+				case rl::KEY_LEFT:  SetExpanded(selected, false); break;
+				default: return false;
+				}
+
+				// Keep the selection on screen
+				row = GetRowOfNode(selected);
+				size_t page = std::max<size_t>(RowsPerPage(area), 1);
+				if (row < scrollRow) scrollRow = row;
+				else if (row >= scrollRow + page) scrollRow = row - page + 1;
+				ClampScroll(area);
+				return true;
+			}
+
+			default: return false;
+			}
+		}
+	};
+}
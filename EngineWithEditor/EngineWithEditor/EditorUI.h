@@ -8,11 +8,13 @@ namespace rl {
 		DrawRectangleLinesEx(rec, 1.0f, linesColor);
 	}
 }
-#include "Types.h"
+#include "EditorUI.DrawList.h"
+#include "EditorUI.Input.h"
 
 
 namespace EditorUI
 {
+	// The grip pattern, which is also raylib's shapes texture (see GenUITextureImage)
 	rl::Texture uiTexture;
 
 	namespace Theme
@@ -23,17 +25,34 @@ namespace EditorUI
 		rl::Color color_main = { 35,35,35,255 };
 		rl::Color color_body = { 20,20,20,255 };
 		int fontSize = 10;
+		// Increment after changing any of the above, so cached panes get redrawn
+		unsigned int version = 0;
 	}
 
-	rl::Shader gripShader;
-	int gripShaderSizeLoc;
+	// Pane names rarely change, so their layout is kept between frames
+	TextCache textCache;
+	// Frames a run can go undrawn before textCache.EvictUnused drops it
+	constexpr uint64_t textCacheMaxAge = 120;
 
 	rl::Shader previewShader;
-	inline void BeginPreviewMode() noexcept(noexcept(rl::BeginShaderMode)) { rl::BeginShaderMode(previewShader); }
-	inline void EndPreviewMode() noexcept(noexcept(rl::EndShaderMode)) { rl::EndShaderMode(); }
+	inline void BeginPreviewMode(DrawList& drawList) { drawList.BeginShaderMode(previewShader); }
+	inline void EndPreviewMode(DrawList& drawList) { drawList.EndShaderMode(); }
 
 	// Size of whichever axis of the grip is fixed
 	constexpr float gripFixedSize = 18;
+	// Period of the grip's dot pattern, in pixels
+	constexpr int gripPatternSize = 6;
+
+	// One tile of the grip's dot pattern, to be sampled with repeat wrapping and point filtering.
+	// Texel (0,0) is one of the white dots, so the texture also works as raylib's shapes texture
+	// (with source {0,0,1,1}), which lets grips and every other shape share a batch.
+	rl::Image GenUITextureImage()
+	{
+		rl::Image image = rl::GenImageColor(gripPatternSize, gripPatternSize, rl::BLANK);
+		rl::ImageDrawPixel(&image, 0, 0, rl::WHITE);
+		rl::ImageDrawPixel(&image, gripPatternSize / 2, gripPatternSize / 2, rl::WHITE);
+		return image;
+	}
 
 	// Mode of the cursor for use in this program (layered on top of Raylibs)
 	enum class CursorShapeMode
@@ -46,15 +65,10 @@ namespace EditorUI
 	};
 	CursorShapeMode cursorShapeMode = CursorShapeMode::none;
 
-	void DrawGrip(rl::Rectangle rect, rl::Color color)
+	// The source rect is the grip's own size, so the pattern repeats once every gripPatternSize pixels
+	void DrawGrip(DrawList& drawList, rl::Rectangle rect, rl::Color color)
 	{
-		{
-			float value[2] = { rect.width, rect.height };
-			rl::SetShaderValue(gripShader, gripShaderSizeLoc, value, rl::SHADER_UNIFORM_VEC2);
-		}
-		rl::BeginShaderMode(gripShader);
-		rl::DrawTexturePro(uiTexture, { 0,0,1,1 }, rect, { 0,0 }, 0.0f, color);
-		rl::EndShaderMode();
+		drawList.DrawTexture(uiTexture, { 0,0,rect.width,rect.height }, rect, color);
 	}
 
 	// A helper for checking where a potential snap is to be connected
@@ -84,7 +98,7 @@ namespace EditorUI
 			for (const rl::Rectangle& rect : regions)
 			{
 				if (rl::CheckCollisionPointRec(point, rect))
-					return IndexToRegion((ptrdiff_t)regions - (ptrdiff_t)&rect);
+					return IndexToRegion(&rect - regions);
 			}
 			return Region::floating;
 		}
@@ -114,6 +128,14 @@ namespace EditorUI
 		return !!((int)set & (int)flag);
 	}
 
+	// What a pane shows below its grip, such as a TreeView
+	__interface IPaneContent
+	{
+		virtual void Draw(DrawList& drawList, rl::Rectangle area) = 0;
+		// Returns whether the content changed and the pane needs redrawing
+		virtual bool HandleEvent(const InputEvent& event, rl::Rectangle area) = 0;
+	};
+
 	// A window that can be moved around on the main window
 	struct Pane
 	{
@@ -125,6 +147,10 @@ namespace EditorUI
 		rl::Rectangle rect;
 		rl::Rectangle gripRect;
 		bool gripIsVertical;
+		// Incremented by Invalidate whenever the pane's content changes
+		unsigned int contentVersion = 0;
+		// Not owned; may be null
+		IPaneContent* content = nullptr;
 
 		enum class HoverRegion
 		{
@@ -152,6 +178,36 @@ namespace EditorUI
 			// Nothing yet
 		}
 
+		// Marks the pane as needing to be redrawn, rather than reusing its cached texture
+		void Invalidate() noexcept { ++contentVersion; }
+
+		// The part of the pane not covered by its grip
+		rl::Rectangle GetContentRect() const noexcept
+		{
+			rl::Rectangle area = rect;
+			if (gripIsVertical)
+			{
+				area.x += gripFixedSize;
+				area.width -= gripFixedSize;
+			}
+			else
+			{
+				area.y += gripFixedSize;
+				area.height -= gripFixedSize;
+			}
+			return area;
+		}
+
+		// Places the pane at rect, e.g. when docked. The grip stays along the top or left edge.
+		void SetRect(rl::Rectangle rect) noexcept
+		{
+			this->rect = rect;
+			gripRect = rect;
+			if (gripIsVertical)
+				gripRect.width = gripFixedSize;
+			else
+				gripRect.height = gripFixedSize;
+		}
 		void Move(rl::Vector2 delta) noexcept
 		{
 			rect.x += delta.x;
@@ -177,10 +233,9 @@ namespace EditorUI
 			}
 		}
 
-		HoverRegion CheckHover()
+		HoverRegion CheckHover() { return CheckHover(rl::GetMousePosition()); }
+		HoverRegion CheckHover(rl::Vector2 cursor)
 		{
-			rl::Vector2 cursor = rl::GetMousePosition();
-
 			// Check if hovering the main rectangle or the grip
 			if (CheckCollisionPointRec(cursor, rect))
 			{
@@ -209,13 +264,15 @@ namespace EditorUI
 			return HoverRegion::notHovering;
 		}
 
-		PaneInteractFlags CheckInteraction(HoverRegion hoverState)
+		// Reacts to a mouse event for the pane that was pressed or is focused, returning its new flags.
+		// hoverState is where the event happened on the pane.
+		PaneInteractFlags HandleEvent(const InputEvent& event, HoverRegion hoverState, PaneInteractFlags flags)
 		{
-			PaneInteractFlags flags = PaneInteractFlags(0);
-
-			// Set states on press
-			if (hoverState != HoverRegion::notHovering && rl::IsMouseButtonPressed(rl::MOUSE_LEFT_BUTTON))
+			switch (event.type)
 			{
+			// Set states on press
+			case InputEvent::Type::mouseDown:
+				if (event.code != rl::MOUSE_LEFT_BUTTON) break;
 				switch (hoverState)
 				{
 				case HoverRegion::edge_right:  flags = PaneInteractFlags::resizingX;								 break;
@@ -223,78 +280,85 @@ namespace EditorUI
 				case HoverRegion::corner:	   flags = PaneInteractFlags::resizingX | PaneInteractFlags::resizingY;  break;
 				case HoverRegion::handle:      flags = PaneInteractFlags::focused | PaneInteractFlags::beingDragged; break;
 				case HoverRegion::hovering:    flags = PaneInteractFlags::focused;									 break;
-				default: break;
+				default:                       flags = PaneInteractFlags(0);										 break;
 				}
-			}
+				break;
 
 			// Reset states on release
-			if (rl::IsMouseButtonReleased(rl::MOUSE_LEFT_BUTTON))
-				flags = flags & PaneInteractFlags::focused;
+			case InputEvent::Type::mouseUp:
+				if (event.code == rl::MOUSE_LEFT_BUTTON) flags = flags & PaneInteractFlags::focused;
+				break;
+
+			case InputEvent::Type::mouseMove:
+				UpdateFocused(flags, event.delta);
+				break;
 
+			default: break;
+			}
 			return flags;
 		}
 
-		void Draw() const
+		void Draw(DrawList& drawList) const
 		{
-			rl::DrawRectangleOutlined(rect, Theme::color_main, Theme::color_accent);
+			drawList.DrawRectangleOutlined(rect, Theme::color_main, Theme::color_accent);
+			const TextRun& nameRun = textCache.Get(name, Theme::fontSize);
 			rl::Rectangle gripDrawRect = gripRect;
 			if (gripIsVertical)
 			{
 				float nameHeight = (float)(Theme::fontSize + 4);
 				gripDrawRect.y += nameHeight;
 				gripDrawRect.height -= nameHeight;
-				DrawGrip(gripDrawRect, Theme::color_accent);
+				DrawGrip(drawList, gripDrawRect, Theme::color_accent);
 			}
 			else
 			{
-				float nameWidth = (float)(rl::MeasureText(name, Theme::fontSize) + 4);
+				float nameWidth = (float)((int)nameRun.width + 4);
 				gripDrawRect.x += nameWidth;
 				gripDrawRect.width -= nameWidth;
-				DrawGrip(gripDrawRect, Theme::color_accent);
+				DrawGrip(drawList, gripDrawRect, Theme::color_accent);
 			}
-			DrawText(name, (int)rect.x + 4, (int)rect.y + 4, Theme::fontSize, Theme::color_foreground);
+			drawList.DrawText(nameRun, (int)rect.x + 4, (int)rect.y + 4, Theme::color_foreground);
+			if (content) content->Draw(drawList, GetContentRect());
 		}
 
-		void UpdateFocused(PaneInteractFlags flags)
+		void UpdateFocused(PaneInteractFlags flags, rl::Vector2 mouseDelta)
 		{
 			// Update things that occur due to interaction
 			{
-				rl::Vector2 mouseDelta = rl::GetMouseDelta();
-
-				{
-					rl::Vector2 resizeDelta = mouseDelta;
-					if (!(flags & PaneInteractFlags::resizingX)) resizeDelta.x = 0;
-					if (!(flags & PaneInteractFlags::resizingY)) resizeDelta.y = 0;
-					Resize(resizeDelta);
-				}
-
-				if (!!(flags & PaneInteractFlags::beingDragged)) Move(mouseDelta);
+				rl::Vector2 resizeDelta = mouseDelta;
+				if (!(flags & PaneInteractFlags::resizingX)) resizeDelta.x = 0;
+				if (!(flags & PaneInteractFlags::resizingY)) resizeDelta.y = 0;
+				Resize(resizeDelta);
 			}
+
+			if (!!(flags & PaneInteractFlags::beingDragged)) Move(mouseDelta);
 		}
 
 		// Assume focused is always true
-		void DrawFocused(PaneInteractFlags flags)
+		void DrawFocused(DrawList& drawList, PaneInteractFlags flags)
 		{
-			if (!!(flags & PaneInteractFlags::beingDragged)) BeginPreviewMode();
-			DrawRectangleOutlined(rect, Theme::color_main, Theme::color_accent);
+			if (!!(flags & PaneInteractFlags::beingDragged)) BeginPreviewMode(drawList);
+			drawList.DrawRectangleOutlined(rect, Theme::color_main, Theme::color_accent);
+			const TextRun& nameRun = textCache.Get(name, Theme::fontSize);
 			rl::Rectangle gripDrawRect = gripRect;
 			if (gripIsVertical)
 			{
 				float nameHeight = (float)(Theme::fontSize + 4);
 				gripDrawRect.y += nameHeight;
 				gripDrawRect.height -= nameHeight;
-				DrawGrip(gripDrawRect, Theme::color_accent);
+				DrawGrip(drawList, gripDrawRect, Theme::color_accent);
 			}
 			else
 			{
-				if (!!(flags & PaneInteractFlags::focused)) DrawRectangleRec(gripRect, Theme::color_highlight);
-				float nameWidth = (float)(rl::MeasureText(name, Theme::fontSize) + 4);
+				if (!!(flags & PaneInteractFlags::focused)) drawList.DrawRectangle(gripRect, Theme::color_highlight);
+				float nameWidth = (float)((int)nameRun.width + 4);
 				gripDrawRect.x += nameWidth;
 				gripDrawRect.width -= nameWidth;
-				DrawGrip(gripDrawRect, Theme::color_foreground);
+				DrawGrip(drawList, gripDrawRect, Theme::color_foreground);
 			}
-			DrawText(name, (int)rect.x + 4, (int)rect.y + 4, Theme::fontSize, Theme::color_foreground);
-			if (!!(flags & PaneInteractFlags::beingDragged)) EndPreviewMode();
+			drawList.DrawText(nameRun, (int)rect.x + 4, (int)rect.y + 4, Theme::color_foreground);
+			if (content) content->Draw(drawList, GetContentRect());
+			if (!!(flags & PaneInteractFlags::beingDragged)) EndPreviewMode(drawList);
 		}
 	};
 	void UpdateCursorShapeModeWithoutOverride(Pane::HoverRegion hoverState)
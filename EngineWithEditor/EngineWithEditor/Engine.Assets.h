@@ -0,0 +1,280 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include "Engine.Core.h"
+
+namespace Engine
+{
+	// 64-bit FNV-1a of an asset path, used as the asset cache key
+	inline uint64_t HashAssetPath(std::string_view path) noexcept
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : path)
+		{
+			hash ^= (unsigned char)c;
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	/***************************************************************
+	* Deduplicating, reference-counted cache of loaded assets.
+	*
+	* Loading a path that is already cached just hands out another
+	* handle. Assets stay loaded after their last handle goes away,
+	* until UnloadUnusedAssets sweeps them, unless they were loaded
+	* with HideFlags::DontUnloadUnusedAsset.
+	***************************************************************/
+	template<class _Asset>
+	class AssetCache
+	{
+	public:
+		using Loader = std::function<_Asset(strcref path)>;
+		using Unloader = std::function<void(_Asset& asset)>;
+
+	private:
+		struct Entry
+		{
+			string path;
+			_Asset asset{};
+			HideFlags flags = HideFlags::None;
+			std::atomic<int> references = 0;
+			bool ready = false; // Guarded by the cache's lock
+		};
+
+		Loader loader;
+		Unloader unloader;
+
+		mutable std::mutex lock;
+		std::condition_variable loaded;
+		std::unordered_map<uint64_t, std::unique_ptr<Entry>> entries;
+
+		// Async loading
+		std::thread worker;
+		std::condition_variable queued;
+		std::deque<Entry*> queue;
+		bool stopping = false;
+
+		// Finds or creates the entry for path. Returns true in created if the caller needs to load it.
+		// Must be called with lock held.
+		Entry* Acquire(strcref path, HideFlags flags, bool& created)
+		{
+			uint64_t key = HashAssetPath(path);
+			auto it = entries.find(key);
+			created = (it == entries.end());
+			Entry* entry;
+			if (created)
+			{
+				entry = entries.emplace(key, std::make_unique<Entry>()).first->second.get();
+				entry->path = path;
+			}
+			else
+			{
+				entry = it->second.get();
+				_ASSERT_EXPR(entry->path == path, L"Asset path hash collision");
+			}
+			entry->flags = HideFlags(entry->flags | flags);
+			entry->references.fetch_add(1, std::memory_order_relaxed);
+			return entry;
+		}
+
+		void WorkerMain()
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			while (true)
+			{
+				queued.wait(guard, [this] { return stopping || !queue.empty(); });
+				if (stopping) return;
+
+				Entry* entry = queue.front();
+				queue.pop_front();
+
+				guard.unlock();
+				_Asset asset = loader(entry->path);
+				guard.lock();
+
+				entry->asset = std::move(asset);
+				entry->ready = true;
+				loaded.notify_all();
+			}
+		}
+
+	public:
+		// Shared ownership of a cached asset
+		class Handle
+		{
+		private:
+			AssetCache* cache = nullptr;
+			Entry* entry = nullptr;
+
+			friend class AssetCache;
+			Handle(AssetCache* cache, Entry* entry) : cache(cache), entry(entry) {}
+
+		public:
+			Handle() = default;
+			Handle(const Handle& other) : cache(other.cache), entry(other.entry)
+			{
+				if (entry) entry->references.fetch_add(1, std::memory_order_relaxed);
+			}
+			Handle(Handle&& other) noexcept : cache(other.cache), entry(other.entry)
+			{
+				other.cache = nullptr;
+				other.entry = nullptr;
+			}
+			Handle& operator=(Handle other) noexcept
+			{
+				std::swap(cache, other.cache);
+				std::swap(entry, other.entry);
+				return *this;
+			}
+			~Handle() { Reset(); }
+
+			void Reset()
+			{
+				if (entry) entry->references.fetch_sub(1, std::memory_order_release);
+				cache = nullptr;
+				entry = nullptr;
+			}
+
+			bool IsValid() const { return !!entry; }
+			bool IsReady() const
+			{
+				if (!entry) return false;
+				std::lock_guard<std::mutex> guard(cache->lock);
+				return entry->ready;
+			}
+			// Blocks until the asset has finished loading
+			const _Asset& Get() const
+			{
+				_ASSERT_EXPR(entry, L"Empty asset handle");
+				std::unique_lock<std::mutex> guard(cache->lock);
+				cache->loaded.wait(guard, [this] { return entry->ready; });
+				return entry->asset;
+			}
+			const _Asset& operator*() const { return Get(); }
+			const _Asset* operator->() const { return &Get(); }
+		};
+
+		AssetCache(Loader loader, Unloader unloader) : loader(std::move(loader)), unloader(std::move(unloader)) {}
+		AssetCache(const AssetCache&) = delete;
+		AssetCache& operator=(const AssetCache&) = delete;
+		~AssetCache()
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				stopping = true;
+			}
+			queued.notify_all();
+			if (worker.joinable()) worker.join();
+			UnloadAll();
+		}
+
+		// Loads path on this thread, or returns the cached asset if it is already loaded
+		Handle Load(strcref path, HideFlags flags = HideFlags::None)
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			bool created;
+			Entry* entry = Acquire(path, flags, created);
+			if (created)
+			{
+				guard.unlock();
+				_Asset asset = loader(path);
+				guard.lock();
+				entry->asset = std::move(asset);
+				entry->ready = true;
+				loaded.notify_all();
+			}
+			return Handle(this, entry);
+		}
+
+		// Queues path to be loaded on the cache's worker thread.
+		// The loader must be safe to call off the main thread (no GPU uploads).
+		Handle LoadAsync(strcref path, HideFlags flags = HideFlags::None)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			bool created;
+			Entry* entry = Acquire(path, flags, created);
+			if (created)
+			{
+				if (!worker.joinable()) worker = std::thread(&AssetCache::WorkerMain, this);
+				queue.push_back(entry);
+				queued.notify_one();
+			}
+			return Handle(this, entry);
+		}
+
+		// Adds an asset that was created in code rather than loaded, under the given key.
+		// If something is already cached or loading under key, asset is unloaded instead, and
+		// the handle is to what was there, so nothing that already holds a handle changes under it.
+		Handle Insert(strcref key, _Asset asset, HideFlags flags = HideFlags::None)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			bool created;
+			Entry* entry = Acquire(key, flags, created);
+			if (created)
+			{
+				entry->asset = std::move(asset);
+				entry->ready = true;
+			}
+			else unloader(asset);
+			return Handle(this, entry);
+		}
+
+		bool IsCached(strcref path) const
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return entries.contains(HashAssetPath(path));
+		}
+		size_t GetCount() const
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return entries.size();
+		}
+
+		// Unloads every asset with no handles left, except those flagged DontUnloadUnusedAsset.
+		// Returns how many were unloaded.
+		size_t UnloadUnusedAssets()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			size_t unloadedCount = 0;
+			for (auto it = entries.begin(); it != entries.end();)
+			{
+				Entry& entry = *it->second;
+				bool unused = entry.ready && entry.references.load(std::memory_order_acquire) == 0;
+				if (unused && !(entry.flags & HideFlags::DontUnloadUnusedAsset))
+				{
+					unloader(entry.asset);
+					it = entries.erase(it);
+					++unloadedCount;
+				}
+				else ++it;
+			}
+			return unloadedCount;
+		}
+
+		// Unloads everything regardless of flags. No handles may be held.
+		void UnloadAll()
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			loaded.wait(guard, [this]
+			{
+				return stopping || std::all_of(entries.begin(), entries.end(), [](const auto& pair) { return pair.second->ready; });
+			});
+			for (auto& [key, entry] : entries)
+			{
+				_ASSERT_EXPR(entry->references.load() == 0, L"Unloading an asset that is still referenced");
+				if (entry->ready) unloader(entry->asset);
+			}
+			entries.clear();
+		}
+	};
+}
@@ -1,6 +1,16 @@
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <span>
 #include <string>
+#include "Platform.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_SSE2 1
+#include <emmintrin.h>
+#else
+#define ENGINE_SSE2 0
+#endif
 
 using namespace std::string_literals;
 
@@ -15,13 +25,8 @@ using cstr = const char*;
 
 #define var auto
 #define interface __interface
-#define as(child, base) dynamic_cast<(base)>((child))
-#define is(child, base) !!as((child),(base))
-#define RO(get_func_name) __declspec(property(get = get_func_name))
-#define WO(set_func_name) __declspec(property(put = set_func_name))
-#define RW(get_func_name, set_func_name) __declspec(property(get = get_func_name, put = set_func_name))
 
-int ClampInt(int x, int min, int max)
+constexpr int ClampInt(int x, int min, int max)
 {
 	return std::min(std::max(min, x), max);
 }
@@ -30,21 +35,21 @@ namespace Engine
 {
 	interface IFormattable
 	{
-		string ToString() const = 0;
+		virtual string ToString() const = 0;
 	};
 
-	class RangeInt : public IFormattable
+	class RangeInt
 	{
 	private:
 		int _start, _length;
 
 	public:
-		int GetStart() const { return _start; }
-		int GetLength() const { return _length; }
-		int GetEnd() const { return _start + _length; }
-		void SetStart(int value) { _start = value; }
-		void SetLength(int value) { _length = value; }
-		void SetEnd(int value) { _length = value - _start; }
+		constexpr int GetStart() const { return _start; }
+		constexpr int GetLength() const { return _length; }
+		constexpr int GetEnd() const { return _start + _length; }
+		constexpr void SetStart(int value) { _start = value; }
+		constexpr void SetLength(int value) { _length = value; }
+		constexpr void SetEnd(int value) { _length = value - _start; }
 
 		// The starting index of the range, where 0 is the first position, 1 is the second, 2 is the third, and so on.
 		RW(GetStart,SetStart) int start;
@@ -54,12 +59,17 @@ namespace Engine
 		RW(GetEnd,SetEnd) int end;
 
 		RangeInt() = default;
-		RangeInt(int start, int length) : _start(start), _length(length) {}
+		constexpr RangeInt(int start, int length) : _start(start), _length(length) {}
+
+		string ToString() const
+		{
+			return "("s + std::to_string(_start) + ", "s + std::to_string(_length) + ")"s;
+		}
 	};
 
 
 	// TODO
-	struct Color : public IFormattable
+	struct Color
 	{
 	private:
 		float _c[4];
@@ -68,7 +78,7 @@ namespace Engine
 		{
 			float linear = srgb / 255.0f;
 			if (linear <= 0.04045f) linear /= 12.92f;
-			else linear = std::powf((linear + 0.055f) / 1.055f, 2.4f);
+			else linear = std::pow((linear + 0.055f) / 1.055f, 2.4f);
 			return linear;
 		}
 		static inline Color LinearFromSRGB(Color srgb)
@@ -84,7 +94,7 @@ namespace Engine
 		{
 			float srgb;
 			if (linear <= 0.0031308f) srgb = linear * 12.92f;
-			else srgb = 1.055f * std::powf(linear, 1.0f / 2.4f) - 0.055f;
+			else srgb = 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
 			return srgb * 255.0f;
 		}
 		static inline Color LinearToSRGB(Color linear)
@@ -97,7 +107,7 @@ namespace Engine
 			return ret;
 		}
 
-		const float* MaxColorComponent() const
+		constexpr const float* MaxColorComponent() const
 		{
 			const float* max = &_c[0];
 			for (int i = 1; i < 4; ++i)
@@ -121,69 +131,85 @@ namespace Engine
 		static const Color blue;
 		static const Color magenta;
 
-		float GetR() const { return _c[0]; }
-		float GetG() const { return _c[1]; }
-		float GetB() const { return _c[2]; }
-		float GetA() const { return _c[3]; }
+		constexpr float GetR() const { return _c[0]; }
+		constexpr float GetG() const { return _c[1]; }
+		constexpr float GetB() const { return _c[2]; }
+		constexpr float GetA() const { return _c[3]; }
+		// The color with its rgb converted from linear to sRGB (gamma) space
 		Color GetGamma() const
 		{
-			TODO 
+			Color ret = *this;
+			for (int i = 0; i < 3; ++i)
+			{
+				ret._c[i] = LinearToSRGB(_c[i]) / 255.0f;
+			}
+			return ret;
 		}
-		float GetGrayscale() const
+		constexpr float GetGrayscale() const
 		{
-			TODO 
+			return 0.299f * _c[0] + 0.587f * _c[1] + 0.114f * _c[2];
 		}
-		float GetLinear() const
+		// The color with its rgb converted from sRGB (gamma) to linear space
+		Color GetLinear() const
 		{
-			TODO 
+			Color ret = *this;
+			for (int i = 0; i < 3; ++i)
+			{
+				ret._c[i] = LinearFromSRGB(_c[i] * 255.0f);
+			}
+			return ret;
 		}
-		float GetMaxColorComponent() const
+		constexpr float GetMaxColorComponent() const
 		{
 			return *MaxColorComponent();
 		}
 
-		void SetR(float value) { _c[0] = value; }
-		void SetG(float value) { _c[1] = value; }
-		void SetB(float value) { _c[2] = value; }
-		void SetA(float value) { _c[3] = value; }
-		void SetGamma(Color value) { for (int i = 0; i < 4; ++i) { _c[i] = value[i]; } }
-		void SetLinear(float value) { _c[3] = value; }
-		void SetMaxColorComponent(float value) { *const_cast<float*>(MaxColorComponent()) = value; }
+		constexpr void SetR(float value) { _c[0] = value; }
+		constexpr void SetG(float value) { _c[1] = value; }
+		constexpr void SetB(float value) { _c[2] = value; }
+		constexpr void SetA(float value) { _c[3] = value; }
+		void SetGamma(Color value) { *this = value.GetLinear(); }
+		constexpr void SetMaxColorComponent(float value) { *const_cast<float*>(MaxColorComponent()) = value; }
 
 		RW(GetR,SetR) float r;
 		RW(GetG,SetG) float g;
 		RW(GetB,SetB) float b;
 		RW(GetA,SetA) float a;
-		RW(Foo,Bar) Color gamma;
-		RO(Foo) float grayscale;
-		RW(Foo,Bar) Color linear;
-		RW(Foo,Bar) float maxColorComponent;
+		RW(GetGamma,SetGamma) Color gamma;
+		RO(GetGrayscale) float grayscale;
+		RO(GetLinear) Color linear;
+		RW(GetMaxColorComponent,SetMaxColorComponent) float maxColorComponent;
 
-		float& operator[](int componentIndex) { return _c[componentIndex]; }
+		constexpr float& operator[](int componentIndex) { return _c[componentIndex]; }
+		constexpr float operator[](int componentIndex) const { return _c[componentIndex]; }
 
 		Color() = default;
-		Color(float r, float g, float b, float a = 1.0f) : _c{ r,g,b,a } {}
+		constexpr Color(float r, float g, float b, float a = 1.0f) : _c{ r,g,b,a } {}
 
-		string ToString() const { TODO }
+		string ToString() const
+		{
+			return "RGBA("s + std::to_string(_c[0]) + ", "s + std::to_string(_c[1]) + ", "s + std::to_string(_c[2]) + ", "s + std::to_string(_c[3]) + ")"s;
+		}
 
-		static Color operator+(Color a, Color b) { return { a.r + b.r, a.g + b.g, a.b + b.b,  a.a + b.a }; }
-		static Color operator-(Color a, Color b) { return { a.r - b.r, a.g - b.g, a.b - b.b,  a.a - b.a }; }
-		static Color operator*(Color a, Color b) { return { a.r * b.r, a.g * b.g, a.b * b.b,  a.a * b.a }; }
-		static Color operator/(Color a, Color b) { return { a.r / b.r, a.g / b.g, a.b / b.b,  a.a / b.a }; }
+		friend constexpr Color operator+(Color a, Color b) { return { a._c[0] + b._c[0], a._c[1] + b._c[1], a._c[2] + b._c[2], a._c[3] + b._c[3] }; }
+		friend constexpr Color operator-(Color a, Color b) { return { a._c[0] - b._c[0], a._c[1] - b._c[1], a._c[2] - b._c[2], a._c[3] - b._c[3] }; }
+		friend constexpr Color operator*(Color a, Color b) { return { a._c[0] * b._c[0], a._c[1] * b._c[1], a._c[2] * b._c[2], a._c[3] * b._c[3] }; }
+		friend constexpr Color operator/(Color a, Color b) { return { a._c[0] / b._c[0], a._c[1] / b._c[1], a._c[2] / b._c[2], a._c[3] / b._c[3] }; }
 	};
-	const Color Color::clear(0, 0, 0, 0);
-	const Color Color::black(0, 0, 0, 1);
-	const Color Color::gray(0.5, 0.5, 0.5, 1);
-	const Color Color::white(1, 1, 1, 1);
-	const Color Color::red(1, 0, 0, 1);
-	const Color Color::yellow(1, 0.92, 0.016, 1);
-	const Color Color::green(0, 1, 0, 1);
-	const Color Color::cyan(0, 1, 1, 1);
-	const Color Color::blue(0, 0, 1, 1);
-	const Color Color::magenta(1, 0, 1, 1);
-
-
-	class Vector2 : public IFormattable
+	inline constexpr Color Color::clear(0, 0, 0, 0);
+	inline constexpr Color Color::black(0, 0, 0, 1);
+	inline constexpr Color Color::gray(0.5f, 0.5f, 0.5f, 1);
+	inline constexpr Color Color::white(1, 1, 1, 1);
+	inline constexpr Color Color::red(1, 0, 0, 1);
+	inline constexpr Color Color::yellow(1, 0.92f, 0.016f, 1);
+	inline constexpr Color Color::green(0, 1, 0, 1);
+	inline constexpr Color Color::cyan(0, 1, 1, 1);
+	inline constexpr Color Color::blue(0, 0, 1, 1);
+	inline constexpr Color Color::magenta(1, 0, 1, 1);
+
+
+	// Plain value type: no IFormattable base, so that arrays of them are tightly packed
+	class Vector2
 	{
 	private:
 		float v[2];
@@ -198,22 +224,22 @@ namespace Engine
 		static const Vector2 up;
 		static const Vector2 zero;
 
-		float GetMagnitude() const { return sqrtf((x * x) + (y * y)); }
+		float GetMagnitude() const { return sqrtf(GetSqrMagnitude()); }
 		Vector2 GetNormalized() const
 		{
-			float length = magnitude;
+			float length = GetMagnitude();
 			if (length <= 0.0f) return { 0.0f,0.0f };
 			float ilength = 1.0f / length;
-			return { x * ilength, y * ilength };
+			return { v[0] * ilength, v[1] * ilength };
 		}
-		float GetSqrMagnitude() const { return ((x * x) + (y * y)); }
-		float& operator[](int index) { return v[index]; }
-		float operator[](int index) const { return v[index]; }
-		float GetX() const { return v[0]; }
-		float GetY() const { return v[1]; }
+		constexpr float GetSqrMagnitude() const { return ((v[0] * v[0]) + (v[1] * v[1])); }
+		constexpr float& operator[](int index) { return v[index]; }
+		constexpr float operator[](int index) const { return v[index]; }
+		constexpr float GetX() const { return v[0]; }
+		constexpr float GetY() const { return v[1]; }
 
-		void SetX(float value) { v[0] = value; }
-		void SetY(float value) { v[1] = value; }
+		constexpr void SetX(float value) { v[0] = value; }
+		constexpr void SetY(float value) { v[1] = value; }
 
 		RO(GetMagnitude) float magnitude;
 		RO(GetNormalized) Vector2 normalized;
@@ -222,80 +248,78 @@ namespace Engine
 		RW(GetY, SetY) float y;
 
 		Vector2() = default;
-		Vector2(float x, float y) : v{ x,y } {}
+		constexpr Vector2(float x, float y) : v{ x,y } {}
 
 		// Exactly equal
-		bool Equals(Vector2 other) const
+		constexpr bool Equals(Vector2 other) const
 		{
 			return
-				other.x == x &&
-				other.y == y;
+				other.v[0] == v[0] &&
+				other.v[1] == v[1];
 		}
 		void Normalize()
 		{
-			Vector2 n = normalized;
-			x = n.x;
-			y = n.y;
+			*this = GetNormalized();
 		}
-		void Set(float x, float y)
+		constexpr void Set(float x, float y)
 		{
-			this->x = x;
-			this->y = y;
+			v[0] = x;
+			v[1] = y;
 		}
 		string ToString() const
 		{
-			return "("s + std::to_string(x) + ", "s + std::to_string(y) + ")"s;
+			return "("s + std::to_string(v[0]) + ", "s + std::to_string(v[1]) + ")"s;
 		}
 
 		static float Angle(Vector2 v1, Vector2 v2)
 		{
-			return atan2f(v2.y, v2.x) - atan2f(v1.y, v1.x);
+			return atan2f(v2.v[1], v2.v[0]) - atan2f(v1.v[1], v1.v[0]);
 		}
 		static Vector2 ClampMagnitude(Vector2 vector, float maxLength)
 		{
-			if (vector.magnitude <= maxLength) return vector;
-			return vector.normalized * maxLength;
+			if (vector.GetMagnitude() <= maxLength) return vector;
+			return vector.GetNormalized() * maxLength;
 		}
-		static float SqrDistance(Vector2 v1, Vector2 v2)
+		static constexpr float SqrDistance(Vector2 v1, Vector2 v2)
 		{
-			return ((v1.x - v2.x) * (v1.x - v2.x) + (v1.y - v2.y) * (v1.y - v2.y));
+			return (v1 - v2).GetSqrMagnitude();
 		}
 		static float Distance(Vector2 v1, Vector2 v2)
 		{
-			return sqrtf((v1.x - v2.x) * (v1.x - v2.x) + (v1.y - v2.y) * (v1.y - v2.y));
+			return sqrtf(SqrDistance(v1, v2));
 		}
-		static float Dot(Vector2 v1, Vector2 v2)
+		static constexpr float Dot(Vector2 v1, Vector2 v2)
 		{
-			return (v1.x * v2.x + v1.y * v2.y);
+			return (v1.v[0] * v2.v[0] + v1.v[1] * v2.v[1]);
 		}
-		static Vector2 Lerp(Vector2 v1, Vector2 v2, float amount)
+		static constexpr Vector2 Lerp(Vector2 v1, Vector2 v2, float amount)
 		{
 			return v1 + (v2 - v1) * amount;
 		}
-		static Vector2 Max(Vector2 v1, Vector2 v2)
+		static constexpr Vector2 Max(Vector2 v1, Vector2 v2)
 		{
-			return { std::max(v1.x, v2.x), std::max(v1.y, v2.y) };
+			return { std::max(v1.v[0], v2.v[0]), std::max(v1.v[1], v2.v[1]) };
 		}
-		static Vector2 Min(Vector2 v1, Vector2 v2)
+		static constexpr Vector2 Min(Vector2 v1, Vector2 v2)
 		{
-			return { std::min(v1.x, v2.x), std::min(v1.y, v2.y) };
+			return { std::min(v1.v[0], v2.v[0]), std::min(v1.v[1], v2.v[1]) };
 		}
 		static Vector2 MoveTowards(Vector2 current, Vector2 target, float maxDistanceDelta)
 		{
 			if (Vector2::Distance(current, target) <= maxDistanceDelta) return target;
-			return current + Vector2(target - current).normalized * maxDistanceDelta;
+			return current + (target - current).GetNormalized() * maxDistanceDelta;
 		}
-		static Vector2 Perpendicular(Vector2 inDirection)
+		static constexpr Vector2 Perpendicular(Vector2 inDirection)
 		{
-			return { -inDirection.y, inDirection.x };
+			return { -inDirection.v[1], inDirection.v[0] };
 		}
-		static Vector2 Reflect(Vector2 v, Vector2 normal)
+		static constexpr Vector2 Reflect(Vector2 v, Vector2 normal)
 		{
 			return v - (normal * 2.0f) * Dot(v, normal);
 		}
-		static Vector2 Scale(Vector2 a, Vector2 b)
+		static constexpr Vector2 Scale(Vector2 a, Vector2 b)
 		{
-			return { a.x * b.x, a.y * b.y };
+			return { a.v[0] * b.v[0], a.v[1] * b.v[1] };
 		}
 		static float SignedAngle(Vector2 v1, Vector2 v2)
 		{
@@ -304,25 +328,31 @@ namespace Engine
 			return angle;
 		}
 
-		Vector2 operator-(Vector2 v2) { return { x - v2.x, y - v2.y }; }
-		Vector2 operator*(Vector2 v2) { return { x * v2.x, y * v2.y }; }
-		Vector2 operator/(Vector2 v2) { return { x / v2.x, y / v2.y }; }
-		Vector2 operator+(Vector2 v2) { return { x + v2.x, y + v2.y }; }
-		Vector2 operator*(float f) { return { x - f, y - f }; }
-		bool operator==(Vector2 v2) { return abs(x - v2.x) < 1e-5 && abs(y - v2.y) < 1e-5; }
+		constexpr Vector2 operator-(Vector2 v2) const { return { v[0] - v2.v[0], v[1] - v2.v[1] }; }
+		constexpr Vector2 operator*(Vector2 v2) const { return { v[0] * v2.v[0], v[1] * v2.v[1] }; }
+		constexpr Vector2 operator/(Vector2 v2) const { return { v[0] / v2.v[0], v[1] / v2.v[1] }; }
+		constexpr Vector2 operator+(Vector2 v2) const { return { v[0] + v2.v[0], v[1] + v2.v[1] }; }
+		constexpr Vector2 operator*(float f) const { return { v[0] * f, v[1] * f }; }
+		constexpr Vector2 operator-() const { return { -v[0], -v[1] }; }
+		// Approximately equal
+		constexpr bool operator==(Vector2 v2) const
+		{
+			float dx = v[0] - v2.v[0], dy = v[1] - v2.v[1];
+			return -1e-5f < dx && dx < 1e-5f && -1e-5f < dy && dy < 1e-5f;
+		}
 	};
-	const Vector2 Vector2::down = Vector2(0, -1);
-	const Vector2 Vector2::left = Vector2(-1, 0);
-	const Vector2 Vector2::negativeInfinity = Vector2(-INFINITY, -INFINITY);
-	const Vector2 Vector2::one = Vector2(1, 1);
-	const Vector2 Vector2::positiveInfinity = Vector2(INFINITY, INFINITY);
-	const Vector2 Vector2::right = Vector2(1, 0);
-	const Vector2 Vector2::up = Vector2(0, 1);
-	const Vector2 Vector2::zero = Vector2(0, 0);
-
-	int size = sizeof(Vector2) / sizeof(float);
-
-	class Rect : public IFormattable
+	inline constexpr Vector2 Vector2::down = Vector2(0, -1);
+	inline constexpr Vector2 Vector2::left = Vector2(-1, 0);
+	inline constexpr Vector2 Vector2::negativeInfinity = Vector2(-INFINITY, -INFINITY);
+	inline constexpr Vector2 Vector2::one = Vector2(1, 1);
+	inline constexpr Vector2 Vector2::positiveInfinity = Vector2(INFINITY, INFINITY);
+	inline constexpr Vector2 Vector2::right = Vector2(1, 0);
+	inline constexpr Vector2 Vector2::up = Vector2(0, 1);
+	inline constexpr Vector2 Vector2::zero = Vector2(0, 0);
+
+	static_assert(sizeof(Vector2) == 2 * sizeof(float), "Vector2 must be two packed floats for the batch kernels");
+
+	class Rect
 	{
 	private:
 		float _x, _y, _w, _h;
@@ -330,36 +360,36 @@ namespace Engine
 	public:
 		static const Rect zero;
 
-		Rect() : _x(0), _y(0), _w(0), _h(0) {}
-		Rect(float width, float height) : _x(0), _y(0), _w(width), _h(height) {}
-		Rect(float x, float y, float width, float height) : _x(x), _y(y), _w(width), _h(height) {}
-
-		void Set(float width, float height) { _w = width; _h = height; }
-		void Set(float x, float y, float width, float height) { _x = x; _y = y; _w = width; _h = height; }
-
-		float GetX() const { return _x; }
-		float GetY() const { return _y; }
-		float GetWidth() const { return _w; }
-		float GetHeight() const { return _h; }
-		float GetXMin() const { return _x; }
-		float GetYMin() const { return _y; }
-		float GetXMax() const { return _x + _w; }
-		float GetYMax() const { return _y + _h; }
-		Vector2 GetPosition() const { return Vector2{ _x,_y }; }
-		Vector2 GetSize() const { return Vector2{ _w,_h }; }
-		Vector2 GetCenter() const { return GetPosition() + GetSize() * 0.5f; }
-
-		void SetX(float value) { _x = value; }
-		void SetY(float value) { _y = value; }
-		void SetWidth(float value) { _w = value; }
-		void SetHeight(float value) { _h = value; }
-		void SetXMin(float value) { _w -= value; _x = value; }
-		void SetYMin(float value) { _h -= value; _y = value; }
-		void SetXMax(float value) { _w = value - _x; }
-		void SetYMax(float value) { _h = value - _y; }
-		void SetPosition(Vector2 value) { _x = value.x; _y = value.y; }
-		void SetSize(Vector2 value) { _w = value.x; _h = value.y; }
-		void SetCenter(Vector2 value) { SetPosition(value - GetSize() * 0.5f); }
+		constexpr Rect() : _x(0), _y(0), _w(0), _h(0) {}
+		constexpr Rect(float width, float height) : _x(0), _y(0), _w(width), _h(height) {}
+		constexpr Rect(float x, float y, float width, float height) : _x(x), _y(y), _w(width), _h(height) {}
+
+		constexpr void Set(float width, float height) { _w = width; _h = height; }
+		constexpr void Set(float x, float y, float width, float height) { _x = x; _y = y; _w = width; _h = height; }
+
+		constexpr float GetX() const { return _x; }
+		constexpr float GetY() const { return _y; }
+		constexpr float GetWidth() const { return _w; }
+		constexpr float GetHeight() const { return _h; }
+		constexpr float GetXMin() const { return _x; }
+		constexpr float GetYMin() const { return _y; }
+		constexpr float GetXMax() const { return _x + _w; }
+		constexpr float GetYMax() const { return _y + _h; }
+		constexpr Vector2 GetPosition() const { return Vector2{ _x,_y }; }
+		constexpr Vector2 GetSize() const { return Vector2{ _w,_h }; }
+		constexpr Vector2 GetCenter() const { return GetPosition() + GetSize() * 0.5f; }
+
+		constexpr void SetX(float value) { _x = value; }
+		constexpr void SetY(float value) { _y = value; }
+		constexpr void SetWidth(float value) { _w = value; }
+		constexpr void SetHeight(float value) { _h = value; }
+		constexpr void SetXMin(float value) { _w += _x - value; _x = value; }
+		constexpr void SetYMin(float value) { _h += _y - value; _y = value; }
+		constexpr void SetXMax(float value) { _w = value - _x; }
+		constexpr void SetYMax(float value) { _h = value - _y; }
+		constexpr void SetPosition(Vector2 value) { _x = value.GetX(); _y = value.GetY(); }
+		constexpr void SetSize(Vector2 value) { _w = value.GetX(); _h = value.GetY(); }
+		constexpr void SetCenter(Vector2 value) { SetPosition(value - GetSize() * 0.5f); }
 
 		RW(GetX, SetX) float x;
 		RW(GetY, SetY) float y;
@@ -373,33 +403,33 @@ namespace Engine
 		RW(GetSize, SetSize) Vector2 size;
 		RW(GetCenter, SetCenter) Vector2 center;
 
-		bool Contains(Vector2 point) const
+		constexpr bool Contains(Vector2 point) const
 		{
-			return (point.x >= xMin) && (point.x <= xMax) && (point.y >= yMin) && (point.y <= yMax);
+			return (point.GetX() >= GetXMin()) && (point.GetX() <= GetXMax()) && (point.GetY() >= GetYMin()) && (point.GetY() <= GetYMax());
 		}
-		bool Overlaps(Rect other) const
+		constexpr bool Overlaps(Rect other) const
 		{
-			return (xMin < other.xMax) && (xMax > other.x) && (yMin < other.yMax) && (yMax > other.yMin);
+			return (GetXMin() < other.GetXMax()) && (GetXMax() > other.GetXMin()) && (GetYMin() < other.GetYMax()) && (GetYMax() > other.GetYMin());
 		}
 		string ToString() const
 		{
 			return "("s + std::to_string(_x) + ", "s + std::to_string(_y) + ", "s + std::to_string(_w) + ", "s + std::to_string(_h) + ")"s;
 		}
 
-		static Rect MinMaxRect(float xmin, float ymin, float xmax, float ymax)
+		static constexpr Rect MinMaxRect(float xmin, float ymin, float xmax, float ymax)
 		{
 			return Rect(xmin, ymin, xmax - xmin, ymax - ymin);
 		}
-		static Vector2 NormalizedToPoint(Rect rectangle, Vector2 normalizedRectCoordinates)
+		static constexpr Vector2 NormalizedToPoint(Rect rectangle, Vector2 normalizedRectCoordinates)
 		{
-			return normalizedRectCoordinates * rectangle.size + rectangle.position;
+			return normalizedRectCoordinates * rectangle.GetSize() + rectangle.GetPosition();
 		}
-		static Vector2 PointToNormalized(Rect rectangle, Vector2 point)
+		static constexpr Vector2 PointToNormalized(Rect rectangle, Vector2 point)
 		{
-			return (point - rectangle.position) / rectangle.size;
+			return (point - rectangle.GetPosition()) / rectangle.GetSize();
 		}
 
-		bool operator==(Rect other)
+		constexpr bool operator==(Rect other) const
 		{
 			return
 				_x == other._x &&
@@ -408,10 +438,189 @@ namespace Engine
 				_h == other._h;
 		}
 	};
-	const Rect Rect::zero = Rect(0, 0, 0, 0);
+	inline constexpr Rect Rect::zero = Rect(0, 0, 0, 0);
+	static_assert(sizeof(Rect) == 4 * sizeof(float), "Rect must be four packed floats for the batch kernels");
+
+	/***************************************************
+	* 2D affine transform, stored as rows
+	*   | m11 m12 |
+	*   | m21 m22 |
+	*   | m31 m32 |  <- translation
+	* Points are treated as row vectors, so (a * b)
+	* applies a first, then b.
+	***************************************************/
+	class Matrix3x2
+	{
+	private:
+		float m[6];
+
+		// fabsf isn't constexpr until C++23
+		static constexpr float Abs(float value) { return value < 0.0f ? -value : value; }
+
+	public:
+		static const Matrix3x2 identity;
+
+		Matrix3x2() = default;
+		constexpr Matrix3x2(float m11, float m12, float m21, float m22, float m31, float m32) : m{ m11, m12, m21, m22, m31, m32 } {}
+
+		constexpr float operator[](int index) const { return m[index]; }
+		constexpr float& operator[](int index) { return m[index]; }
+
+		constexpr Vector2 GetTranslation() const { return Vector2(m[4], m[5]); }
+		constexpr void SetTranslation(Vector2 value) { m[4] = value.GetX(); m[5] = value.GetY(); }
+		constexpr float GetDeterminant() const { return m[0] * m[3] - m[1] * m[2]; }
+
+		RW(GetTranslation, SetTranslation) Vector2 translation;
+		RO(GetDeterminant) float determinant;
+
+		static constexpr Matrix3x2 Translate(Vector2 offset)
+		{
+			return Matrix3x2(1, 0, 0, 1, offset.GetX(), offset.GetY());
+		}
+		// Counter-clockwise, in radians
+		static Matrix3x2 Rotate(float radians)
+		{
+			float c = cosf(radians);
+			float s = sinf(radians);
+			return Matrix3x2(c, s, -s, c, 0, 0);
+		}
+		static constexpr Matrix3x2 Scale(Vector2 scale)
+		{
+			return Matrix3x2(scale.GetX(), 0, 0, scale.GetY(), 0, 0);
+		}
+		// Scale, then rotate, then translate
+		static Matrix3x2 TRS(Vector2 translation, float radians, Vector2 scale)
+		{
+			float c = cosf(radians);
+			float s = sinf(radians);
+			float sx = scale.GetX(), sy = scale.GetY();
+			return Matrix3x2(c * sx, s * sx, -s * sy, c * sy, translation.GetX(), translation.GetY());
+		}
+
+		// a first, then b
+		static constexpr Matrix3x2 Multiply(const Matrix3x2& a, const Matrix3x2& b)
+		{
+			return Matrix3x2(
+				a.m[0] * b.m[0] + a.m[1] * b.m[2],
+				a.m[0] * b.m[1] + a.m[1] * b.m[3],
+				a.m[2] * b.m[0] + a.m[3] * b.m[2],
+				a.m[2] * b.m[1] + a.m[3] * b.m[3],
+				a.m[4] * b.m[0] + a.m[5] * b.m[2] + b.m[4],
+				a.m[4] * b.m[1] + a.m[5] * b.m[3] + b.m[5]);
+		}
+		// Returns false, leaving result untouched, if the matrix is singular
+		static constexpr bool Invert(const Matrix3x2& matrix, Matrix3x2& result)
+		{
+			float det = matrix.GetDeterminant();
+			if (Abs(det) < 1e-12f) return false;
+			float invDet = 1.0f / det;
+			const float* a = matrix.m;
+			float i11 =  a[3] * invDet;
+			float i12 = -a[1] * invDet;
+			float i21 = -a[2] * invDet;
+			float i22 =  a[0] * invDet;
+			result = Matrix3x2(i11, i12, i21, i22,
+				-(a[4] * i11 + a[5] * i21),
+				-(a[4] * i12 + a[5] * i22));
+			return true;
+		}
+		// Identity if the matrix is singular
+		constexpr Matrix3x2 GetInverse() const
+		{
+			Matrix3x2 result = identity;
+			Invert(*this, result);
+			return result;
+		}
+		RO(GetInverse) Matrix3x2 inverse;
+
+		// Applies rotation, scale and translation
+		constexpr Vector2 MultiplyPoint(Vector2 point) const
+		{
+			float x = point.GetX(), y = point.GetY();
+			return Vector2(x * m[0] + y * m[2] + m[4], x * m[1] + y * m[3] + m[5]);
+		}
+		// Applies rotation and scale only, for directions and offsets
+		constexpr Vector2 MultiplyVector(Vector2 vector) const
+		{
+			float x = vector.GetX(), y = vector.GetY();
+			return Vector2(x * m[0] + y * m[2], x * m[1] + y * m[3]);
+		}
+		// The smallest axis-aligned rect containing the transformed rect
+		constexpr Rect MultiplyRect(Rect rect) const
+		{
+			float ex = rect.GetWidth() * 0.5f, ey = rect.GetHeight() * 0.5f;
+			Vector2 center = MultiplyPoint(Vector2(rect.GetX() + ex, rect.GetY() + ey));
+			float nex = Abs(m[0]) * ex + Abs(m[2]) * ey;
+			float ney = Abs(m[1]) * ex + Abs(m[3]) * ey;
+			return Rect(center.GetX() - nex, center.GetY() - ney, nex * 2.0f, ney * 2.0f);
+		}
+
+		constexpr Matrix3x2 operator*(const Matrix3x2& other) const { return Multiply(*this, other); }
+	};
+	inline constexpr Matrix3x2 Matrix3x2::identity = Matrix3x2(1, 0, 0, 1, 0, 0);
 
+	// Transforms every point in place by matrix
+	inline void TransformPoints(const Matrix3x2& matrix, std::span<Vector2> points)
+	{
+		size_t i = 0;
+#if ENGINE_SSE2
+		// Two points per register: [x0 y0 x1 y1]
+		const __m128 row1 = _mm_setr_ps(matrix[0], matrix[1], matrix[0], matrix[1]);
+		const __m128 row2 = _mm_setr_ps(matrix[2], matrix[3], matrix[2], matrix[3]);
+		const __m128 row3 = _mm_setr_ps(matrix[4], matrix[5], matrix[4], matrix[5]);
+		float* data = reinterpret_cast<float*>(points.data());
+		for (; i + 2 <= points.size(); i += 2)
+		{
+			__m128 xy = _mm_loadu_ps(data + i * 2);
+			__m128 xx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 2, 0, 0));
+			__m128 yy = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(3, 3, 1, 1));
+			__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, row1), _mm_mul_ps(yy, row2)), row3);
+			_mm_storeu_ps(data + i * 2, result);
+		}
+#endif
+		for (; i < points.size(); ++i)
+		{
+			points[i] = matrix.MultiplyPoint(points[i]);
+		}
+	}
 
-	class Vector2Int : public IFormattable
+	// Writes the axis-aligned bounds of each transformed rect into bounds, which must be at least as long as rects.
+	// Lets a whole sprite list be culled against the view in one pass.
+	inline void TransformRectsToAABB(const Matrix3x2& matrix, std::span<const Rect> rects, std::span<Rect> bounds)
+	{
+		_ASSERT_EXPR(bounds.size() >= rects.size(), L"Output span is too short");
+		size_t i = 0;
+#if ENGINE_SSE2
+		// Produces [centerX centerY extentX extentY] from [cx cx ex ex] and [cy cy ey ey] in one multiply-add
+		const __m128 linear1 = _mm_setr_ps(matrix[0], matrix[1], fabsf(matrix[0]), fabsf(matrix[1]));
+		const __m128 linear2 = _mm_setr_ps(matrix[2], matrix[3], fabsf(matrix[2]), fabsf(matrix[3]));
+		const __m128 offset = _mm_setr_ps(matrix[4], matrix[5], 0.0f, 0.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 lowMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, 0, 0));
+		const __m128 extentScale = _mm_setr_ps(-1.0f, -1.0f, 2.0f, 2.0f);
+		const float* src = reinterpret_cast<const float*>(rects.data());
+		float* dst = reinterpret_cast<float*>(bounds.data());
+		for (; i < rects.size(); ++i)
+		{
+			__m128 rect = _mm_loadu_ps(src + i * 4);                                               // x  y  w  h
+			__m128 extent = _mm_mul_ps(_mm_shuffle_ps(rect, rect, _MM_SHUFFLE(3, 2, 3, 2)), half); // ex ey ex ey
+			__m128 center = _mm_add_ps(rect, extent);                                              // cx cy -  -
+			__m128 a = _mm_shuffle_ps(center, extent, _MM_SHUFFLE(0, 0, 0, 0));                   // cx cx ex ex
+			__m128 b = _mm_shuffle_ps(center, extent, _MM_SHUFFLE(1, 1, 1, 1));                   // cy cy ey ey
+			__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, linear1), _mm_mul_ps(b, linear2)), offset);
+			__m128 newExtent = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 2, 3, 2));                     // ex' ey' ex' ey'
+			__m128 result = _mm_add_ps(_mm_and_ps(r, lowMask), _mm_mul_ps(newExtent, extentScale));
+			_mm_storeu_ps(dst + i * 4, result);
+		}
+#endif
+		for (; i < rects.size(); ++i)
+		{
+			bounds[i] = matrix.MultiplyRect(rects[i]);
+		}
+	}
+
+
+	class Vector2Int
 	{
 	private:
 		int v[2];
@@ -424,15 +633,15 @@ namespace Engine
 		static const Vector2Int up;
 		static const Vector2Int zero;
 
-		float GetMagnitude() const { return sqrtf(((float)x * (float)x) + ((float)y * (float)y)); }
-		float GetSqrMagnitude() const { return (((float)x * (float)x) + ((float)y * (float)y)); }
-		int& operator[](int index) { return v[index]; }
-		int operator[](int index) const { return v[index]; }
-		int GetX() const { return v[0]; }
-		int GetY() const { return v[1]; }
+		float GetMagnitude() const { return sqrtf(GetSqrMagnitude()); }
+		constexpr float GetSqrMagnitude() const { return (((float)v[0] * (float)v[0]) + ((float)v[1] * (float)v[1])); }
+		constexpr int& operator[](int index) { return v[index]; }
+		constexpr int operator[](int index) const { return v[index]; }
+		constexpr int GetX() const { return v[0]; }
+		constexpr int GetY() const { return v[1]; }
 
-		void SetX(int value) { v[0] = value; }
-		void SetY(int value) { v[1] = value; }
+		constexpr void SetX(int value) { v[0] = value; }
+		constexpr void SetY(int value) { v[1] = value; }
 
 		RO(GetMagnitude) float magnitude;
 		RO(GetSqrMagnitude) float sqrMagnitude;
@@ -440,75 +649,77 @@ namespace Engine
 		RW(GetY, SetY) int y;
 
 		Vector2Int() = default;
-		Vector2Int(int x, int y) : v{ x,y } {}
+		constexpr Vector2Int(int x, int y) : v{ x,y } {}
 
-		void Clamp(Vector2Int min, Vector2Int max)
+		constexpr void Clamp(Vector2Int min, Vector2Int max)
 		{
 			v[0] = ClampInt(v[0], min.v[0], max.v[0]);
 			v[1] = ClampInt(v[1], min.v[1], max.v[1]);
 		}
-		bool Equals(Vector2Int other) const
+		constexpr bool Equals(Vector2Int other) const
 		{
-			return x == other.x && y == other.y;
+			return v[0] == other.v[0] && v[1] == other.v[1];
 		}
-		void Set(int x, int y)
+		constexpr void Set(int x, int y)
 		{
-			this->x = x;
-			this->y = y;
+			v[0] = x;
+			v[1] = y;
 		}
 		string ToString() const
 		{
-			return "("s + std::to_string(x) + ", "s + std::to_string(y) + ")"s;
+			return "("s + std::to_string(v[0]) + ", "s + std::to_string(v[1]) + ")"s;
 		}
 
 		static Vector2Int CeilToInt(Vector2 vector)
 		{
-			return { (int)ceilf(vector.x), (int)ceilf(vector.y) };
+			return { (int)ceilf(vector.GetX()), (int)ceilf(vector.GetY()) };
 		}
 		static Vector2Int FloorToInt(Vector2 vector)
 		{
-			return { (int)floorf(vector.x), (int)floorf(vector.y) };
+			return { (int)floorf(vector.GetX()), (int)floorf(vector.GetY()) };
 		}
 		static Vector2Int RoundToInt(Vector2 vector)
 		{
-			return { (int)roundf(vector.x), (int)roundf(vector.y) };
+			return { (int)roundf(vector.GetX()), (int)roundf(vector.GetY()) };
 		}
 		static float Distance(Vector2Int v1, Vector2Int v2)
 		{
-			return sqrtf(((float)v1.x - (float)v2.x) * ((float)v1.x - (float)v2.x) + ((float)v1.y - (float)v2.y) * ((float)v1.y - (float)v2.y));
+			return (v1 - v2).GetMagnitude();
 		}
-		static Vector2Int Max(Vector2Int v1, Vector2Int v2)
+		static constexpr Vector2Int Max(Vector2Int v1, Vector2Int v2)
 		{
-			return { std::max(v1.x, v2.x), std::max(v1.y, v2.y) };
+			return { std::max(v1.v[0], v2.v[0]), std::max(v1.v[1], v2.v[1]) };
 		}
-		static Vector2Int Min(Vector2Int v1, Vector2Int v2)
+		static constexpr Vector2Int Min(Vector2Int v1, Vector2Int v2)
 		{
-			return { std::min(v1.x, v2.x), std::min(v1.y, v2.y) };
+			return { std::min(v1.v[0], v2.v[0]), std::min(v1.v[1], v2.v[1]) };
 		}
-		static Vector2Int Scale(Vector2Int a, Vector2Int b)
+		static constexpr Vector2Int Scale(Vector2Int a, Vector2Int b)
 		{
-			return { a.x * b.x, a.y * b.y };
+			return { a.v[0] * b.v[0], a.v[1] * b.v[1] };
 		}
 
-		Vector2Int operator-(Vector2Int v2) { return { x - v2.x, y - v2.y }; }
-		Vector2Int operator*(Vector2Int v2) { return { x * v2.x, y * v2.y }; }
-		Vector2Int operator/(Vector2Int v2) { return { x / v2.x, y / v2.y }; }
-		Vector2Int operator+(Vector2Int v2) { return { x + v2.x, y + v2.y }; }
-		Vector2Int operator*(int f) { return { x - f, y - f }; }
-		bool operator!=(Vector2Int v2) { return x != v2.x || y != v2.y; }
-		bool operator==(Vector2Int v2) { return x == v2.x && y == v2.y; }
-
-		operator Vector2()
+		constexpr Vector2Int operator-(Vector2Int v2) const { return { v[0] - v2.v[0], v[1] - v2.v[1] }; }
+		constexpr Vector2Int operator*(Vector2Int v2) const { return { v[0] * v2.v[0], v[1] * v2.v[1] }; }
+		constexpr Vector2Int operator/(Vector2Int v2) const { return { v[0] / v2.v[0], v[1] / v2.v[1] }; }
+		constexpr Vector2Int operator+(Vector2Int v2) const { return { v[0] + v2.v[0], v[1] + v2.v[1] }; }
+		constexpr Vector2Int operator*(int f) const { return { v[0] * f, v[1] * f }; }
+		constexpr Vector2Int operator/(int f) const { return { v[0] / f, v[1] / f }; }
+		constexpr Vector2Int operator-() const { return { -v[0], -v[1] }; }
+		constexpr bool operator!=(Vector2Int v2) const { return !Equals(v2); }
+		constexpr bool operator==(Vector2Int v2) const { return Equals(v2); }
+
+		constexpr operator Vector2() const
 		{
-			return { (float)x,(float)y };
+			return { (float)v[0],(float)v[1] };
 		}
 	};
-	const Vector2Int Vector2Int::down = Vector2Int(0, -1);
-	const Vector2Int Vector2Int::left = Vector2Int(-1, 0);
-	const Vector2Int Vector2Int::one = Vector2Int(1, 1);
-	const Vector2Int Vector2Int::right = Vector2Int(1, 0);
-	const Vector2Int Vector2Int::up = Vector2Int(0, 1);
-	const Vector2Int Vector2Int::zero = Vector2Int(0, 0);
+	inline constexpr Vector2Int Vector2Int::down = Vector2Int(0, -1);
+	inline constexpr Vector2Int Vector2Int::left = Vector2Int(-1, 0);
+	inline constexpr Vector2Int Vector2Int::one = Vector2Int(1, 1);
+	inline constexpr Vector2Int Vector2Int::right = Vector2Int(1, 0);
+	inline constexpr Vector2Int Vector2Int::up = Vector2Int(0, 1);
+	inline constexpr Vector2Int Vector2Int::zero = Vector2Int(0, 0);
 
 	class PositionCollection;
 	class PositionEnumerator
@@ -529,8 +740,8 @@ namespace Engine
 		Vector2Int operator*() { return pos; }
 		Vector2Int* operator->() { return &pos; }
 		PositionEnumerator& operator++() { MoveNext(); return *this; }
-		bool operator==(PositionEnumerator other) const { return &src == &other.src && pos == other.pos; }
-		bool operator!=(PositionEnumerator other) const { return &src != &other.src || pos != other.pos; }
+		bool operator==(PositionEnumerator other) const { return src == other.src && pos.Equals(other.pos); }
+		bool operator!=(PositionEnumerator other) const { return !(*this == other); }
 	};
 	class PositionCollection
 	{
@@ -540,68 +751,219 @@ namespace Engine
 		friend class PositionEnumerator;
 
 	public:
+		bool IsEmpty() const { return xmin >= xmax || ymin >= ymax; }
+
+		// Interleaves the low 16 bits of x and y into a Z-order index
+		static unsigned int EncodeMorton(unsigned int x, unsigned int y)
+		{
+			auto spread = [](unsigned int v)
+			{
+				v &= 0x0000FFFF;
+				v = (v | (v << 8)) & 0x00FF00FF;
+				v = (v | (v << 4)) & 0x0F0F0F0F;
+				v = (v | (v << 2)) & 0x33333333;
+				v = (v | (v << 1)) & 0x55555555;
+				return v;
+			};
+			return spread(x) | (spread(y) << 1);
+		}
+		static Vector2Int DecodeMorton(unsigned int code)
+		{
+			auto compact = [](unsigned int v)
+			{
+				v &= 0x55555555;
+				v = (v | (v >> 1)) & 0x33333333;
+				v = (v | (v >> 2)) & 0x0F0F0F0F;
+				v = (v | (v >> 4)) & 0x00FF00FF;
+				v = (v | (v >> 8)) & 0x0000FFFF;
+				return v;
+			};
+			return Vector2Int((int)compact(code), (int)compact(code >> 1));
+		}
+
+	private:
+		template<class _Fn>
+		void MortonBlock(int bx, int by, int blockSize, _Fn& callback) const
+		{
+			if (bx >= xmax || by >= ymax) return;
+
+			// Whole block is inside; walk its codes directly instead of recursing
+			if (bx + blockSize <= xmax && by + blockSize <= ymax && blockSize <= mortonLeafSize)
+			{
+				unsigned int count = (unsigned int)(blockSize * blockSize);
+				for (unsigned int code = 0; code < count; ++code)
+				{
+					Vector2Int offset = DecodeMorton(code);
+					callback(Vector2Int(bx + offset.GetX(), by + offset.GetY()));
+				}
+				return;
+			}
+			if (blockSize == 1)
+			{
+				callback(Vector2Int(bx, by));
+				return;
+			}
+
+			int half = blockSize / 2;
+			MortonBlock(bx,        by,        half, callback);
+			MortonBlock(bx + half, by,        half, callback);
+			MortonBlock(bx,        by + half, half, callback);
+			MortonBlock(bx + half, by + half, half, callback);
+		}
+
+	public:
+		// Order in which ForEach visits positions
+		enum class Order
+		{
+			// Row by row, like the enumerator
+			rowMajor,
+			// tileSize x tileSize tiles, row-major within and between tiles
+			tiled,
+			// Z-order curve starting at the minimum corner
+			morton,
+		};
+
+		static constexpr int tileSize = 8;
+		static constexpr int mortonLeafSize = 8;
+
 		PositionCollection(int xmin, int xmax, int ymin, int ymax) : xmin(xmin), xmax(xmax), ymin(ymin), ymax(ymax) {}
 		PositionEnumerator begin() const
 		{
-			return { this, { xmin, ymin } };
+			return IsEmpty() ? end() : PositionEnumerator{ this, { xmin, ymin } };
 		}
 		PositionEnumerator end() const
 		{
-			return { this, { xmax, ymax } };
+			return { this, { xmin, std::max(ymin, ymax) } };
+		}
+
+		// Calls callback(y, xBegin, xEnd) once per row, with xEnd exclusive.
+		// Prefer this over the enumerator for hot loops, as the inner loop is left to the caller.
+		template<class _Fn>
+		void ForEachRow(_Fn&& callback) const
+		{
+			if (IsEmpty()) return;
+			for (int y = ymin; y < ymax; ++y)
+			{
+				callback(y, xmin, xmax);
+			}
+		}
+
+		// Calls callback(y, xBegin, xEnd) for each row of each _TileSize x _TileSize tile, one tile at a time
+		template<int _TileSize = tileSize, class _Fn>
+		void ForEachTileRow(_Fn&& callback) const
+		{
+			static_assert(_TileSize > 0, "Tile size must be positive");
+			if (IsEmpty()) return;
+			for (int ty = ymin; ty < ymax; ty += _TileSize)
+			{
+				int tyEnd = std::min(ty + _TileSize, ymax);
+				for (int tx = xmin; tx < xmax; tx += _TileSize)
+				{
+					int txEnd = std::min(tx + _TileSize, xmax);
+					for (int y = ty; y < tyEnd; ++y)
+					{
+						callback(y, tx, txEnd);
+					}
+				}
+			}
+		}
+
+		// Calls callback(Vector2Int) for every position, one _TileSize x _TileSize tile at a time
+		template<int _TileSize = tileSize, class _Fn>
+		void ForEachTiled(_Fn&& callback) const
+		{
+			ForEachTileRow<_TileSize>([&](int y, int xBegin, int xEnd)
+			{
+				for (int x = xBegin; x < xEnd; ++x)
+				{
+					callback(Vector2Int(x, y));
+				}
+			});
+		}
+
+		// Calls callback(Vector2Int) for every position in Morton (Z) order.
+		// Partial blocks at the edges are clipped rather than padded.
+		template<class _Fn>
+		void ForEachMorton(_Fn&& callback) const
+		{
+			if (IsEmpty()) return;
+			int extent = std::max(xmax - xmin, ymax - ymin);
+			int blockSize = 1;
+			while (blockSize < extent) blockSize *= 2;
+			MortonBlock(xmin, ymin, blockSize, callback);
+		}
+
+		// Calls callback(Vector2Int) for every position in the given order
+		template<class _Fn>
+		void ForEach(Order order, _Fn&& callback) const
+		{
+			switch (order)
+			{
+			case Order::rowMajor:
+				ForEachRow([&](int y, int xBegin, int xEnd)
+				{
+					for (int x = xBegin; x < xEnd; ++x)
+					{
+						callback(Vector2Int(x, y));
+					}
+				});
+				break;
+			case Order::tiled:  ForEachTiled(callback);  break;
+			case Order::morton: ForEachMorton(callback); break;
+			}
 		}
 	};
-	void PositionEnumerator::MoveNext()
+	inline void PositionEnumerator::MoveNext()
 	{
-		pos.x++;
-		if (pos.x == src->xmax)
+		pos.SetX(pos.GetX() + 1);
+		if (pos.GetX() == src->xmax)
 		{
-			pos.x = src->xmin;
-			pos.y++;
+			pos.SetX(src->xmin);
+			pos.SetY(pos.GetY() + 1);
 		}
 	}
-	void PositionEnumerator::Reset()
+	inline void PositionEnumerator::Reset()
 	{
-		pos.x = src->xmin;
-		pos.y = src->ymin;
+		pos = Vector2Int(src->xmin, src->ymin);
 	}
 
-	class RectInt : public IFormattable
+	class RectInt
 	{
 	private:
 		int _x, _y, _w, _h;
 
 	public:
-		RectInt() : _x(0), _y(0), _w(0), _h(0) {}
-		RectInt(int width, int height) : _x(0), _y(0), _w(width), _h(height) {}
-		RectInt(int x, int y, int width, int height) : _x(x), _y(y), _w(width), _h(height) {}
-
-		void Set(int width, int height) { _w = width; _h = height; }
-		void Set(int x, int y, int width, int height) { _x = x; _y = y; _w = width; _h = height; }
-
-		PositionCollection GetAllPositionsWithin() { return PositionCollection(_x, _x + _w, _y, _y + _h); }
-		int GetX() const { return _x; }
-		int GetY() const { return _y; }
-		int GetWidth() const { return _w; }
-		int GetHeight() const { return _h; }
-		int GetXMin() const { return _x; }
-		int GetYMin() const { return _y; }
-		int GetXMax() const { return _x + _w; }
-		int GetYMax() const { return _y + _h; }
-		Vector2Int GetPosition() const { return Vector2Int{ _x,_y }; }
-		Vector2Int GetSize() const { return Vector2Int{ _w,_h }; }
-		Vector2Int GetCenter() const { return GetPosition() + GetSize() * 0.5f; } // Todo: Make this not a float or something
-
-		void SetX(int value) { _x = value; }
-		void SetY(int value) { _y = value; }
-		void SetWidth(int value) { _w = value; }
-		void SetHeight(int value) { _h = value; }
-		void SetXMin(int value) { _w -= value; _x = value; }
-		void SetYMin(int value) { _h -= value; _y = value; }
-		void SetXMax(int value) { _w = value - _x; }
-		void SetYMax(int value) { _h = value - _y; }
-		void SetPosition(Vector2Int value) { _x = value.x; _y = value.y; }
-		void SetSize(Vector2Int value) { _w = value.x; _h = value.y; }
-		void SetCenter(Vector2Int value) { SetPosition(value - GetSize() * 0.5f); } // Todo: Make this not a float or something
+		constexpr RectInt() : _x(0), _y(0), _w(0), _h(0) {}
+		constexpr RectInt(int width, int height) : _x(0), _y(0), _w(width), _h(height) {}
+		constexpr RectInt(int x, int y, int width, int height) : _x(x), _y(y), _w(width), _h(height) {}
+
+		constexpr void Set(int width, int height) { _w = width; _h = height; }
+		constexpr void Set(int x, int y, int width, int height) { _x = x; _y = y; _w = width; _h = height; }
+
+		PositionCollection GetAllPositionsWithin() const { return PositionCollection(_x, _x + _w, _y, _y + _h); }
+		constexpr int GetX() const { return _x; }
+		constexpr int GetY() const { return _y; }
+		constexpr int GetWidth() const { return _w; }
+		constexpr int GetHeight() const { return _h; }
+		constexpr int GetXMin() const { return _x; }
+		constexpr int GetYMin() const { return _y; }
+		constexpr int GetXMax() const { return _x + _w; }
+		constexpr int GetYMax() const { return _y + _h; }
+		constexpr Vector2Int GetPosition() const { return Vector2Int{ _x,_y }; }
+		constexpr Vector2Int GetSize() const { return Vector2Int{ _w,_h }; }
+		constexpr Vector2Int GetCenter() const { return GetPosition() + GetSize() / 2; }
+
+		constexpr void SetX(int value) { _x = value; }
+		constexpr void SetY(int value) { _y = value; }
+		constexpr void SetWidth(int value) { _w = value; }
+		constexpr void SetHeight(int value) { _h = value; }
+		constexpr void SetXMin(int value) { _w += _x - value; _x = value; }
+		constexpr void SetYMin(int value) { _h += _y - value; _y = value; }
+		constexpr void SetXMax(int value) { _w = value - _x; }
+		constexpr void SetYMax(int value) { _h = value - _y; }
+		constexpr void SetPosition(Vector2Int value) { _x = value.GetX(); _y = value.GetY(); }
+		constexpr void SetSize(Vector2Int value) { _w = value.GetX(); _h = value.GetY(); }
+		constexpr void SetCenter(Vector2Int value) { SetPosition(value - GetSize() / 2); }
 
 		RO(GetAllPositionsWithin) PositionCollection allPositionsWithin;
 		RW(GetX, SetX) int x;
@@ -616,18 +978,18 @@ namespace Engine
 		RW(GetSize, SetSize) Vector2Int size;
 		RW(GetCenter, SetCenter) Vector2Int center;
 
-		void ClampToBounds(RectInt bounds)
+		constexpr void ClampToBounds(RectInt bounds)
 		{
-			xMin = std::max(xMin, bounds.xMin);
-			yMin = std::max(yMin, bounds.yMin);
-			xMax = std::min(xMax, bounds.xMax);
-			yMax = std::min(yMax, bounds.yMax);
+			SetXMin(std::max(GetXMin(), bounds.GetXMin()));
+			SetYMin(std::max(GetYMin(), bounds.GetYMin()));
+			SetXMax(std::min(GetXMax(), bounds.GetXMax()));
+			SetYMax(std::min(GetYMax(), bounds.GetYMax()));
 		}
-		bool Contains(Vector2Int point) const
+		constexpr bool Contains(Vector2Int point) const
 		{
-			return (point.x >= xMin) && (point.x <= xMax) && (point.y >= yMin) && (point.y <= yMax);
+			return (point.GetX() >= GetXMin()) && (point.GetX() <= GetXMax()) && (point.GetY() >= GetYMin()) && (point.GetY() <= GetYMax());
 		}
-		bool Equals(RectInt other) const
+		constexpr bool Equals(RectInt other) const
 		{
 			return
 				_x == other._x &&
@@ -635,16 +997,16 @@ namespace Engine
 				_w == other._w &&
 				_h == other._h;
 		}
-		bool Overlaps(RectInt other) const
+		constexpr bool Overlaps(RectInt other) const
 		{
-			return (xMin < other.xMax) && (xMax > other.x) && (yMin < other.yMax) && (yMax > other.yMin);
+			return (GetXMin() < other.GetXMax()) && (GetXMax() > other.GetXMin()) && (GetYMin() < other.GetYMax()) && (GetYMax() > other.GetYMin());
 		}
-		void SetMinMax(Vector2Int min, Vector2Int max)
+		constexpr void SetMinMax(Vector2Int min, Vector2Int max)
 		{
-			_x = min.x;
-			_y = min.y;
-			_h = max.x - _x;
-			_w = max.y - _y;
+			_x = min.GetX();
+			_y = min.GetY();
+			_w = max.GetX() - _x;
+			_h = max.GetY() - _y;
 		}
 		string ToString() const
 		{
@@ -652,57 +1014,58 @@ namespace Engine
 		}
 	};
 
-	class RectOffset : public IFormattable
+	// The value types are literal types, so constants and tables of them are baked at compile time
+	static_assert(Vector2::up + Vector2::right == Vector2::one);
+	static_assert(Vector2Int::left * 3 == Vector2Int(-3, 0));
+	static_assert(Rect(0, 0, 4, 2).GetCenter() == Vector2(2, 1));
+	static_assert(RectInt(2, 2, 4, 4).Overlaps(RectInt(5, 5, 1, 1)));
+	static_assert((Color::red + Color::blue).GetB() == Color::magenta.GetB());
+
+	class RectOffset
 	{
 	private:
-		int left, top, right, bottom;
+		int _left = 0, _top = 0, _right = 0, _bottom = 0;
 
 	public:
-		int GetBottom()		const { return bottom; }
-		int GetHorizontal() const { return left + right; }
-		int GetLeft()		const { return left; }
-		int GetRight()		const { return right; }
-		int GetTop()		const { return top; }
-		int GetVertical()	const { return top + bottom; }
-
-		void SetBottom	(int value) { bottom = value; }
-		void SetLeft	(int value) { left = value; }
-		void SetRight	(int value) { right = value; }
-		void SetTop		(int value) { top = value; }
+		int GetBottom()		const { return _bottom; }
+		int GetHorizontal() const { return _left + _right; }
+		int GetLeft()		const { return _left; }
+		int GetRight()		const { return _right; }
+		int GetTop()		const { return _top; }
+		int GetVertical()	const { return _top + _bottom; }
+
+		void SetBottom	(int value) { _bottom = value; }
+		void SetLeft	(int value) { _left = value; }
+		void SetRight	(int value) { _right = value; }
+		void SetTop		(int value) { _top = value; }
 
 		RO(GetHorizontal) int horizontal;
 		RO(GetVertical) int vertical;
-		RW(GetBottom, SetBottom) int x;
-		RW(GetLeft, SetLeft) int x;
-		RW(GetRight, SetRight) int x;
-		RW(GetTop, SetTop) int x;
+		RW(GetBottom, SetBottom) int bottom;
+		RW(GetLeft, SetLeft) int left;
+		RW(GetRight, SetRight) int right;
+		RW(GetTop, SetTop) int top;
 
 		RectOffset() = default;
-		RectOffset(int left, int right, int top, int bottom) : left(left), right(right), top(top), bottom(bottom) {}
+		RectOffset(int left, int right, int top, int bottom) : _left(left), _top(top), _right(right), _bottom(bottom) {}
 
 		// I have interpreted as "expand"
-		Rect Add(Rect rect)
+		Rect Add(Rect rect) const
 		{
-			Rect result;
-			result.xMin = rect.xMin - left;
-			result.yMin = rect.yMin - top;
-			result.xMax = rect.xMax + right;
-			result.yMax = rect.yMax + bottom;
-			return result;
+			return Rect::MinMaxRect(
+				rect.GetXMin() - _left, rect.GetYMin() - _top,
+				rect.GetXMax() + _right, rect.GetYMax() + _bottom);
 		}
 		// I have interpreted as "contract"
-		Rect Remove(Rect rect)
+		Rect Remove(Rect rect) const
 		{
-			Rect result;
-			result.xMin = rect.xMin + left;
-			result.yMin = rect.yMin + top;
-			result.xMax = rect.xMax - right;
-			result.yMax = rect.yMax - bottom;
-			return result;
+			return Rect::MinMaxRect(
+				rect.GetXMin() + _left, rect.GetYMin() + _top,
+				rect.GetXMax() - _right, rect.GetYMax() - _bottom);
 		}
 		string ToString() const
 		{
-			return "("s + std::to_string(left) + ", "s + std::to_string(top) + ", "s + std::to_string(right) + ", "s + std::to_string(bottom) + ")"s;
+			return "("s + std::to_string(_left) + ", "s + std::to_string(_top) + ", "s + std::to_string(_right) + ", "s + std::to_string(_bottom) + ")"s;
 		}
 	};
 
@@ -749,7 +1112,7 @@ namespace Engine
 	class Object : public IFormattable
 	{
 	private:
-		HideFlags _hideFlags;
+		HideFlags _hideFlags = HideFlags::None;
 		string _name;
 		bool _destroyOnLoad = true;
 
@@ -763,6 +1126,7 @@ namespace Engine
 		RW(GetHideFlags, SetHideFlags) HideFlags hideFlags;
 		RW(GetName, SetName) string name;
 
+		virtual ~Object() = default;
 		virtual string ToString() const { return _name; }
 
 		static void Destroy(Object* target) { delete target; }
@@ -805,14 +1169,20 @@ namespace Engine
 	class Behavior : public Component
 	{
 	private:
-		bool enabled;
+		bool _enabled = true;
 		
 	public:
-		bool IsEnabled() const { TODO }
-		void SetEnabled(bool value) { TODO }
+		bool IsEnabled() const { return _enabled; }
+		void SetEnabled(bool value) { _enabled = value; }
 
 		RW(IsEnabled,SetEnabled) bool enabled;
 		RW(IsEnabled,Bar) bool isActiveAndEnabled;
+
+		// Called once per frame while enabled
+		virtual void Update() {}
+		// Return true if Update only touches this behavior's own state.
+		// Thread-safe behaviors are updated in parallel batches.
+		virtual bool IsThreadSafe() const { return false; }
 	};
 
 
@@ -863,16 +1233,16 @@ namespace Engine
 		void TransformVector() { TODO }
 		void Translate() { TODO }
 	};
-	static Object* Instantiate(const Object& original, Transform* parent)
+	inline Object* Object::Instantiate(const Object& original, Transform* parent)
 	{
-		Object* newObject = new Object(original);
-		dynamic_cast<Object>()
-		
+		// todo: attach to parent once Transform has a hierarchy
+		(void)parent;
+		return new Object(original);
 	}
 
 
 	// todo
-	class RectTransform : public Transform, public IFormattable
+	class RectTransform : public Transform
 	{
 	private:
 
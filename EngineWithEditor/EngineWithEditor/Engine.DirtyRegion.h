@@ -0,0 +1,188 @@
+#pragma once
+#include <vector>
+#include "Engine.Core.h"
+
+namespace Engine
+{
+	/******************************************************
+	* Accumulates the RectInts invalidated during a frame
+	* so that only those areas need to be redrawn.
+	*
+	* Overlapping and adjacent rects are merged whenever
+	* that doesn't add any pixels, and the set is capped
+	* at maxRects by merging whichever pair wastes least.
+	******************************************************/
+	class DirtyRegionSet
+	{
+	private:
+		// Min/max edges, exclusive of the max
+		struct Box
+		{
+			int xMin, yMin, xMax, yMax;
+
+			long long Area() const { return (long long)(xMax - xMin) * (long long)(yMax - yMin); }
+			bool IsEmpty() const { return xMin >= xMax || yMin >= yMax; }
+			bool Contains(const Box& other) const
+			{
+				return xMin <= other.xMin && yMin <= other.yMin && other.xMax <= xMax && other.yMax <= yMax;
+			}
+			// True when the boxes overlap or share an edge
+			bool Touches(const Box& other) const
+			{
+				return xMin <= other.xMax && other.xMin <= xMax && yMin <= other.yMax && other.yMin <= yMax;
+			}
+			RectInt ToRect() const { return RectInt(xMin, yMin, xMax - xMin, yMax - yMin); }
+
+			static Box FromRect(const RectInt& rect)
+			{
+				return { rect.GetXMin(), rect.GetYMin(), rect.GetXMax(), rect.GetYMax() };
+			}
+			static Box Union(const Box& a, const Box& b)
+			{
+				return { std::min(a.xMin, b.xMin), std::min(a.yMin, b.yMin), std::max(a.xMax, b.xMax), std::max(a.yMax, b.yMax) };
+			}
+			static Box Intersection(const Box& a, const Box& b)
+			{
+				return { std::max(a.xMin, b.xMin), std::max(a.yMin, b.yMin), std::min(a.xMax, b.xMax), std::min(a.yMax, b.yMax) };
+			}
+			// Pixels the union would cover that neither box does
+			static long long Waste(const Box& a, const Box& b)
+			{
+				Box overlap = Intersection(a, b);
+				long long shared = overlap.IsEmpty() ? 0 : overlap.Area();
+				return Union(a, b).Area() - (a.Area() + b.Area() - shared);
+			}
+		};
+
+		std::vector<Box> boxes;
+		Box bounds;
+		bool hasBounds = false;
+		size_t maxRects;
+
+		// Folds box into the set, merging for free where possible
+		void Add(Box box)
+		{
+			bool merged;
+			do
+			{
+				merged = false;
+				for (size_t i = 0; i < boxes.size(); ++i)
+				{
+					const Box& other = boxes[i];
+					if (other.Contains(box)) return;
+					if (box.Contains(other) || (box.Touches(other) && Box::Waste(box, other) == 0))
+					{
+						box = Box::Union(box, other);
+						boxes[i] = boxes.back();
+						boxes.pop_back();
+						merged = true;
+						break;
+					}
+				}
+			} while (merged);
+
+			boxes.push_back(box);
+		}
+
+		// Merges the cheapest pairs until the set fits within maxRects
+		void Reduce()
+		{
+			while (boxes.size() > maxRects)
+			{
+				size_t bestA = 0, bestB = 1;
+				long long bestWaste = Box::Waste(boxes[0], boxes[1]);
+				for (size_t a = 0; a < boxes.size(); ++a)
+				{
+					for (size_t b = a + 1; b < boxes.size(); ++b)
+					{
+						long long waste = Box::Waste(boxes[a], boxes[b]);
+						if (waste < bestWaste)
+						{
+							bestWaste = waste;
+							bestA = a;
+							bestB = b;
+						}
+					}
+				}
+				Box merged = Box::Union(boxes[bestA], boxes[bestB]);
+				boxes[bestB] = boxes.back();
+				boxes.pop_back();
+				boxes[bestA] = boxes.back();
+				boxes.pop_back();
+				Add(merged);
+			}
+		}
+
+	public:
+		// maxRects: Upper bound on how many rects the frame's repaint is split into
+		DirtyRegionSet(size_t maxRects = 16) : bounds{ 0,0,0,0 }, maxRects(std::max<size_t>(maxRects, 1)) {}
+
+		// Invalidated rects are clipped to these bounds, typically the view's rect
+		void SetBounds(RectInt value)
+		{
+			bounds = Box::FromRect(value);
+			hasBounds = true;
+		}
+		RectInt GetBounds() const { return bounds.ToRect(); }
+
+		size_t GetMaxRects() const { return maxRects; }
+		void SetMaxRects(size_t value)
+		{
+			maxRects = std::max<size_t>(value, 1);
+			Reduce();
+		}
+
+		void Invalidate(RectInt rect)
+		{
+			Box box = Box::FromRect(rect);
+			if (hasBounds) box = Box::Intersection(box, bounds);
+			if (box.IsEmpty()) return;
+			Add(box);
+			Reduce();
+		}
+		void InvalidateAll()
+		{
+			_ASSERT_EXPR(hasBounds, L"InvalidateAll requires bounds");
+			boxes.clear();
+			if (!bounds.IsEmpty()) boxes.push_back(bounds);
+		}
+
+		bool IsDirty() const { return !boxes.empty(); }
+		// Draw loops can skip anything for which this is false
+		bool IsDirty(RectInt area) const
+		{
+			Box box = Box::FromRect(area);
+			for (const Box& dirty : boxes)
+			{
+				if (!Box::Intersection(dirty, box).IsEmpty()) return true;
+			}
+			return false;
+		}
+
+		size_t GetRectCount() const { return boxes.size(); }
+		// Pixels that will be repainted. Rects that partially overlap are counted twice,
+		// so this is an upper bound.
+		long long GetDirtyArea() const
+		{
+			long long area = 0;
+			for (const Box& box : boxes)
+			{
+				area += box.Area();
+			}
+			return area;
+		}
+
+		// Writes the rects to repaint into rects and clears the set for the next frame
+		void Flush(std::vector<RectInt>& rects)
+		{
+			rects.clear();
+			rects.reserve(boxes.size());
+			for (const Box& box : boxes)
+			{
+				rects.push_back(box.ToRect());
+			}
+			boxes.clear();
+		}
+		void Clear() { boxes.clear(); }
+	};
+}
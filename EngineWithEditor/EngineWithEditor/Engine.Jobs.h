@@ -0,0 +1,305 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include "Engine.Core.h"
+#include "Debug.Trace.h"
+#include "Engine.Profiler.h"
+
+namespace Engine
+{
+	class JobSystem;
+
+	namespace _Jobs
+	{
+		struct Job
+		{
+			std::function<void()> task;
+			// Dependencies still running, plus one held while the job is being scheduled
+			std::atomic<int> pendingDependencies = 1;
+
+			std::mutex lock;
+			bool finished = false;
+			std::vector<std::shared_ptr<Job>> dependents;
+		};
+	}
+
+	// Refers to a scheduled job. Default-constructed handles count as already finished.
+	class JobHandle
+	{
+	private:
+		std::shared_ptr<_Jobs::Job> job;
+
+		friend class JobSystem;
+		JobHandle(std::shared_ptr<_Jobs::Job> job) : job(std::move(job)) {}
+
+	public:
+		JobHandle() = default;
+
+		bool IsFinished() const
+		{
+			if (!job) return true;
+			std::lock_guard<std::mutex> guard(job->lock);
+			return job->finished;
+		}
+	};
+
+	/**********************************************************
+	* Work-stealing job scheduler.
+	*
+	* Every worker (and the thread that owns the JobSystem)
+	* has its own deque. Workers pop their newest job first,
+	* and steal the oldest job from someone else when empty.
+	* Jobs may depend on other jobs, and only become runnable
+	* once all of their dependencies have finished.
+	**********************************************************/
+	class JobSystem
+	{
+	private:
+		using JobPtr = std::shared_ptr<_Jobs::Job>;
+
+		struct WorkQueue
+		{
+			std::mutex lock;
+			std::deque<JobPtr> jobs;
+		};
+
+		std::vector<std::unique_ptr<WorkQueue>> queues; // One per worker, the last belongs to the owning thread
+		std::vector<std::thread> workers;
+		std::atomic<size_t> nextQueue = 0;
+
+		std::mutex sleepLock;
+		std::condition_variable wake;
+		std::atomic<int> queuedJobs = 0;
+		std::atomic<bool> stopping = false;
+
+		// Index into queues of the current thread, if it belongs to this system
+		static inline thread_local const JobSystem* currentSystem = nullptr;
+		static inline thread_local size_t currentQueue = 0;
+
+		size_t QueueForThisThread()
+		{
+			if (currentSystem == this) return currentQueue;
+			return nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+		}
+
+		void Enqueue(JobPtr job)
+		{
+			WorkQueue& queue = *queues[QueueForThisThread()];
+			{
+				std::lock_guard<std::mutex> guard(queue.lock);
+				queue.jobs.push_back(std::move(job));
+			}
+			{
+				// Held so a worker can't miss the wake-up between checking and sleeping
+				std::lock_guard<std::mutex> guard(sleepLock);
+				queuedJobs.fetch_add(1, std::memory_order_release);
+			}
+			wake.notify_one();
+		}
+
+		// Drops one pending dependency, enqueueing the job if it was the last
+		void Release(JobPtr job)
+		{
+			if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				Enqueue(std::move(job));
+		}
+
+		JobPtr Pop(size_t self)
+		{
+			// Own queue, newest first: it's the most likely to still be in cache
+			{
+				WorkQueue& queue = *queues[self];
+				std::lock_guard<std::mutex> guard(queue.lock);
+				if (!queue.jobs.empty())
+				{
+					JobPtr job = std::move(queue.jobs.back());
+					queue.jobs.pop_back();
+					return job;
+				}
+			}
+			// Steal the oldest job from someone else
+			for (size_t i = 1; i < queues.size(); ++i)
+			{
+				WorkQueue& queue = *queues[(self + i) % queues.size()];
+				std::lock_guard<std::mutex> guard(queue.lock);
+				if (!queue.jobs.empty())
+				{
+					JobPtr job = std::move(queue.jobs.front());
+					queue.jobs.pop_front();
+					return job;
+				}
+			}
+			return nullptr;
+		}
+
+		void Execute(JobPtr job)
+		{
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			if (job->task) job->task();
+
+			std::vector<JobPtr> dependents;
+			{
+				std::lock_guard<std::mutex> guard(job->lock);
+				job->finished = true;
+				dependents.swap(job->dependents);
+			}
+			for (JobPtr& dependent : dependents)
+			{
+				Release(std::move(dependent));
+			}
+		}
+
+		bool TryRunOne(size_t self)
+		{
+			JobPtr job = Pop(self);
+			if (!job) return false;
+			Execute(std::move(job));
+			return true;
+		}
+
+		void WorkerMain(size_t index)
+		{
+			currentSystem = this;
+			currentQueue = index;
+			while (!stopping.load(std::memory_order_acquire))
+			{
+				if (TryRunOne(index)) continue;
+
+				std::unique_lock<std::mutex> guard(sleepLock);
+				wake.wait(guard, [this]
+				{
+					return stopping.load(std::memory_order_acquire) || queuedJobs.load(std::memory_order_acquire) > 0;
+				});
+			}
+		}
+
+	public:
+		// workerCount: Threads to spawn in addition to the owning thread.
+		// Defaults to one less than the number of hardware threads.
+		JobSystem(size_t workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1)
+		{
+			queues.reserve(workerCount + 1);
+			for (size_t i = 0; i < workerCount + 1; ++i)
+			{
+				queues.push_back(std::make_unique<WorkQueue>());
+			}
+
+			currentSystem = this;
+			currentQueue = workerCount;
+
+			workers.reserve(workerCount);
+			for (size_t i = 0; i < workerCount; ++i)
+			{
+				workers.emplace_back(&JobSystem::WorkerMain, this, i);
+			}
+		}
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+		~JobSystem()
+		{
+			{
+				std::lock_guard<std::mutex> guard(sleepLock);
+				stopping.store(true, std::memory_order_release);
+			}
+			wake.notify_all();
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+			if (currentSystem == this) currentSystem = nullptr;
+		}
+
+		// Number of threads that run jobs, including the owning thread
+		size_t GetThreadCount() const { return queues.size(); }
+
+		// Schedules task to run once every job in dependencies has finished
+		JobHandle Schedule(std::function<void()> task, std::span<const JobHandle> dependencies = {})
+		{
+			JobPtr job = std::make_shared<_Jobs::Job>();
+			job->task = std::move(task);
+
+			for (const JobHandle& dependency : dependencies)
+			{
+				if (!dependency.job) continue;
+				std::lock_guard<std::mutex> guard(dependency.job->lock);
+				if (dependency.job->finished) continue;
+				job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+				dependency.job->dependents.push_back(job);
+			}
+
+			JobHandle handle(job);
+			Release(std::move(job));
+			return handle;
+		}
+		JobHandle Schedule(std::function<void()> task, std::initializer_list<JobHandle> dependencies)
+		{
+			return Schedule(std::move(task), std::span<const JobHandle>(dependencies.begin(), dependencies.size()));
+		}
+
+		// Splits [0, count) into batches of batchSize and calls body(begin, end) for each, in parallel.
+		// The returned handle finishes once every batch has.
+		JobHandle ParallelFor(size_t count, size_t batchSize, std::function<void(size_t, size_t)> body, std::span<const JobHandle> dependencies = {})
+		{
+			if (batchSize == 0) batchSize = 1;
+			auto shared = std::make_shared<std::function<void(size_t, size_t)>>(std::move(body));
+
+			std::vector<JobHandle> batches;
+			batches.reserve((count + batchSize - 1) / batchSize);
+			for (size_t begin = 0; begin < count; begin += batchSize)
+			{
+				size_t end = std::min(begin + batchSize, count);
+				batches.push_back(Schedule([shared, begin, end] { (*shared)(begin, end); }, dependencies));
+			}
+			return Schedule(nullptr, batches);
+		}
+
+		// Runs other jobs on this thread until handle has finished
+		void Wait(const JobHandle& handle)
+		{
+			size_t self = QueueForThisThread();
+			while (!handle.IsFinished())
+			{
+				if (!TryRunOne(self)) std::this_thread::yield();
+			}
+		}
+	};
+
+	// Updates every enabled behavior once. Those that report IsThreadSafe are split
+	// into batches across the job system, while the rest run in order on this thread.
+	inline void UpdateBehaviors(std::span<Behavior* const> behaviors, JobSystem& jobs, size_t batchSize = 64)
+	{
+		DEBUG_TRACE_SCOPE("UpdateBehaviors");
+		ENGINE_PROFILE_SCOPE("UpdateBehaviors");
+		std::vector<Behavior*> parallel;
+		std::vector<Behavior*> serial;
+		for (Behavior* behavior : behaviors)
+		{
+			if (!behavior || !behavior->IsEnabled()) continue;
+			(behavior->IsThreadSafe() ? parallel : serial).push_back(behavior);
+		}
+
+		JobHandle parallelDone = jobs.ParallelFor(parallel.size(), batchSize, [&parallel](size_t begin, size_t end)
+		{
+			DEBUG_TRACE_SCOPE("UpdateBehaviors batch");
+			ENGINE_PROFILE_SCOPE("UpdateBehaviors batch");
+			for (size_t i = begin; i < end; ++i)
+			{
+				parallel[i]->Update();
+			}
+		});
+
+		for (Behavior* behavior : serial)
+		{
+			behavior->Update();
+		}
+
+		jobs.Wait(parallelDone);
+	}
+}
@@ -0,0 +1,260 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Platform.h"
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ENGINE_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ENGINE_PROFILER_RDTSC 1
+#else
+#define ENGINE_PROFILER_RDTSC 0
+#endif
+
+// 0 compiles every ENGINE_PROFILE_SCOPE out
+#ifndef ENGINE_PROFILER
+#define ENGINE_PROFILER 1
+#endif
+
+namespace Engine
+{
+	namespace Profiler
+	{
+		// A timed scope that has ended. Times are in ticks of the profiler's clock.
+		struct ScopeEvent
+		{
+			const char* name;
+			int64_t start;
+			int64_t end;
+			uint32_t depth; // Scopes open around it on the same thread
+		};
+
+		// Everything one scope name took in a frame
+		struct ScopeTotal
+		{
+			const char* name;
+			int64_t start;  // Of its first call, in ticks
+			int64_t nanoseconds;
+			uint32_t calls;
+			uint32_t depth; // Shallowest it was seen at
+		};
+
+		struct FrameRecord
+		{
+			int64_t start;
+			int64_t nanoseconds;
+		};
+
+		namespace _Profiler
+		{
+			// Per thread, so recording never contends. Must be a power of two.
+			constexpr size_t bufferSize = 4096;
+			constexpr size_t historySize = 256;
+
+			struct ThreadBuffer
+			{
+				std::array<ScopeEvent, bufferSize> events;
+				std::atomic<uint64_t> written = 0; // Total ever written; only the owning thread stores
+				std::atomic<uint64_t> read = 0;    // Up to where EndFrame has summed; only EndFrame stores
+				uint32_t depth = 0;
+			};
+
+			inline std::atomic<bool> enabled = false;
+			inline std::mutex lock; // Guards buffers
+			// Kept after their threads exit until EndFrame has summed what they recorded
+			inline std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+			inline ThreadBuffer& LocalBuffer()
+			{
+				thread_local std::shared_ptr<ThreadBuffer> buffer = []
+				{
+					std::shared_ptr<ThreadBuffer> created = std::make_shared<ThreadBuffer>();
+					std::lock_guard<std::mutex> guard(lock);
+					buffers.push_back(created);
+					return created;
+				}();
+				return *buffer;
+			}
+
+			inline int64_t Now()
+			{
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			}
+
+			// What scopes are timed with: the timestamp counter where there is one, which
+			// takes about half as long to read as steady_clock, else steady_clock itself
+			inline int64_t Ticks()
+			{
+#if ENGINE_PROFILER_RDTSC
+				return (int64_t)__rdtsc();
+#else
+				return Now();
+#endif
+			}
+
+			// Ticks are converted with the rate measured against steady_clock since the first frame
+			inline int64_t calibrationNanoseconds = 0;
+			inline int64_t calibrationTicks = 0;
+			inline double nanosecondsPerTick = 1;
+			inline void Calibrate()
+			{
+#if ENGINE_PROFILER_RDTSC
+				int64_t nanoseconds = Now(), ticks = Ticks();
+				if (!calibrationTicks)
+				{
+					calibrationNanoseconds = nanoseconds;
+					calibrationTicks = ticks;
+				}
+				else if (ticks > calibrationTicks)
+				{
+					nanosecondsPerTick = (double)(nanoseconds - calibrationNanoseconds) / (double)(ticks - calibrationTicks);
+				}
+#endif
+			}
+
+			inline std::array<FrameRecord, historySize> history = {};
+			inline size_t frameCount = 0;
+			inline int64_t frameStart = 0;
+			inline std::vector<ScopeTotal> lastFrame;
+		}
+
+		inline bool IsEnabled() { return _Profiler::enabled.load(std::memory_order_relaxed); }
+		inline void SetEnabled(bool enabled) { _Profiler::enabled.store(enabled, std::memory_order_relaxed); }
+
+		/*************************************************************
+		* Times the enclosing block into the thread's ring buffer.
+		* Use ENGINE_PROFILE_SCOPE("name") rather than this directly.
+		*
+		* Names are string literals, so recording one is a pointer
+		* copy. While the profiler is disabled a scope only checks
+		* the flag. A scope that ends while its thread's ring is
+		* full of events EndFrame hasn't summed yet is dropped.
+		*************************************************************/
+		class Scope
+		{
+		private:
+			const char* name;
+			int64_t start = 0;
+
+		public:
+			template<size_t _Size>
+			explicit Scope(const char (&name)[_Size]) noexcept : name(IsEnabled() ? name : nullptr)
+			{
+				if (!this->name) return;
+				++_Profiler::LocalBuffer().depth;
+				start = _Profiler::Ticks();
+			}
+			~Scope() noexcept
+			{
+				if (!name) return;
+				int64_t end = _Profiler::Ticks();
+				_Profiler::ThreadBuffer& buffer = _Profiler::LocalBuffer();
+				uint32_t depth = --buffer.depth;
+				uint64_t written = buffer.written.load(std::memory_order_relaxed);
+				// EndFrame may still be reading the slot this would overwrite
+				if (written - buffer.read.load(std::memory_order_acquire) >= _Profiler::bufferSize) return;
+				buffer.events[written & (_Profiler::bufferSize - 1)] = { name, start, end, depth };
+				buffer.written.store(written + 1, std::memory_order_release);
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		};
+
+		// Starts timing a frame. Call at the top of the main loop, after any wait for input,
+		// so an editor idling in rl::EnableEventWaiting doesn't show up as slow frames.
+		inline void BeginFrame()
+		{
+			_Profiler::Calibrate();
+			_Profiler::frameStart = _Profiler::Now();
+		}
+
+		// Closes the frame: records its length and sums the scopes every thread has
+		// ended since the previous EndFrame into GetLastFrame. Call from one thread.
+		// A name used on several threads, such as a job's, gets their combined time.
+		inline void EndFrame()
+		{
+			using namespace _Profiler;
+			int64_t now = Now();
+			if (frameStart)
+			{
+				history[frameCount % historySize] = { frameStart, now - frameStart };
+				++frameCount;
+				frameStart = 0;
+			}
+			Calibrate();
+
+			lastFrame.clear();
+			std::lock_guard<std::mutex> guard(lock);
+			for (size_t b = 0; b < buffers.size();)
+			{
+				const std::shared_ptr<ThreadBuffer>& buffer = buffers[b];
+				// Checked before reading, so nothing the thread recorded before exiting is missed
+				bool exited = buffer.use_count() == 1;
+				std::atomic_thread_fence(std::memory_order_acquire);
+				uint64_t read = buffer->read.load(std::memory_order_relaxed);
+				uint64_t written = buffer->written.load(std::memory_order_acquire);
+				for (uint64_t i = read; i < written; ++i)
+				{
+					const ScopeEvent& event = buffer->events[i & (bufferSize - 1)];
+					ScopeTotal* total = nullptr;
+					for (ScopeTotal& existing : lastFrame)
+					{
+						// The same literal can have different addresses in different translation units
+						if (existing.name == event.name || std::strcmp(existing.name, event.name) == 0)
+						{
+							total = &existing;
+							break;
+						}
+					}
+					if (!total) total = &lastFrame.emplace_back(ScopeTotal{ event.name, event.start, 0, 0, event.depth });
+					total->nanoseconds += (int64_t)((double)(event.end - event.start) * nanosecondsPerTick);
+					++total->calls;
+					total->start = std::min(total->start, event.start);
+					total->depth = std::min(total->depth, event.depth);
+				}
+				buffer->read.store(written, std::memory_order_release);
+
+				if (!exited)
+				{
+					++b;
+					continue;
+				}
+				buffers[b] = std::move(buffers.back());
+				buffers.pop_back();
+			}
+			// Scopes end inside out, so put them back in the order they began, parents first
+			std::sort(lastFrame.begin(), lastFrame.end(), [](const ScopeTotal& a, const ScopeTotal& b) { return a.start < b.start; });
+		}
+
+		// Scopes of the most recently ended frame, in the order they were first entered
+		inline const std::vector<ScopeTotal>& GetLastFrame() { return _Profiler::lastFrame; }
+
+		// Frames recorded so far, of which the latest historySize are kept
+		inline size_t GetFrameCount() { return _Profiler::frameCount; }
+		inline size_t GetHistorySize() { return _Profiler::historySize; }
+		// framesAgo 0 is the most recent complete frame
+		inline FrameRecord GetFrame(size_t framesAgo)
+		{
+			_ASSERT_EXPR(framesAgo < _Profiler::frameCount && framesAgo < _Profiler::historySize, L"Frame is not in the history");
+			return _Profiler::history[(_Profiler::frameCount - 1 - framesAgo) % _Profiler::historySize];
+		}
+	}
+}
+
+#define _ENGINE_PROFILE_CONCAT2(a, b) a##b
+#define _ENGINE_PROFILE_CONCAT(a, b) _ENGINE_PROFILE_CONCAT2(a, b)
+#if ENGINE_PROFILER
+// Times the rest of the enclosing block as name, which must be a string literal
+#define ENGINE_PROFILE_SCOPE(name) ::Engine::Profiler::Scope _ENGINE_PROFILE_CONCAT(_profileScope, __LINE__)(name)
+#else
+#define ENGINE_PROFILE_SCOPE(name) ((void)0)
+#endif
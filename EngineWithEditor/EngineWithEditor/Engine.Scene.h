@@ -0,0 +1,281 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "Engine.Core.h"
+
+#if _WIN32
+// Keep windows.h from defining names that clash with raylib's (DrawText, CloseWindow, Rectangle...)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NOGDI
+#define NOUSER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Engine
+{
+	// Which of the DontSave flags applies when writing a scene
+	enum class SceneTarget
+	{
+		editor, // Skips DontSaveInEditor
+		build,  // Skips DontSaveInBuild
+	};
+
+	/*************************************************************
+	* Binary scene format
+	*
+	* [SceneHeader][SceneObjectRecord * objectCount][strings]
+	*
+	* Everything is written relative to the start of the file, so
+	* it can be mapped straight into memory. Loading only has to
+	* turn each record's string offset into a pointer, instead of
+	* parsing every object.
+	*************************************************************/
+	struct SceneHeader
+	{
+		static constexpr uint32_t magicValue = 0x43535748; // "HWSC"
+		static constexpr uint16_t currentVersion = 1;
+
+		uint32_t magic;
+		uint16_t version;
+		uint16_t reserved;
+		uint32_t objectCount;
+		uint32_t objectsOffset;
+		uint64_t stringsOffset;
+		uint64_t stringsSize;
+	};
+	static_assert(sizeof(SceneHeader) == 32, "SceneHeader is part of the file format");
+
+	struct SceneObjectRecord
+	{
+		// Offset into the strings block on disk, and a pointer once loaded
+		union
+		{
+			uint64_t nameOffset;
+			const char* name;
+		};
+		uint32_t nameLength;
+		uint8_t hideFlags;
+		uint8_t reserved[3];
+
+		std::string_view GetName() const { return std::string_view(name, nameLength); }
+		HideFlags GetHideFlags() const { return (HideFlags)hideFlags; }
+	};
+	static_assert(sizeof(SceneObjectRecord) == 16, "SceneObjectRecord is part of the file format");
+
+	inline bool ShouldSave(const Object& object, SceneTarget target)
+	{
+		HideFlags skip = (target == SceneTarget::editor) ? HideFlags::DontSaveInEditor : HideFlags::DontSaveInBuild;
+		return !(object.GetHideFlags() & skip);
+	}
+
+	// Writes every object that isn't flagged DontSave for target.
+	// Returns false if the file couldn't be written.
+	inline bool SaveScene(_In_z_ const char* path, std::span<const Object* const> objects, SceneTarget target)
+	{
+		std::vector<SceneObjectRecord> records;
+		std::vector<char> strings;
+		records.reserve(objects.size());
+
+		for (const Object* object : objects)
+		{
+			if (!object || !ShouldSave(*object, target)) continue;
+
+			strcref name = object->GetName();
+			SceneObjectRecord record = {};
+			record.nameOffset = strings.size();
+			record.nameLength = (uint32_t)name.size();
+			record.hideFlags = (uint8_t)object->GetHideFlags();
+			records.push_back(record);
+
+			strings.insert(strings.end(), name.begin(), name.end());
+			strings.push_back('\0'); // So the loaded name can be used as a C string too
+		}
+
+		SceneHeader header = {};
+		header.magic = SceneHeader::magicValue;
+		header.version = SceneHeader::currentVersion;
+		header.objectCount = (uint32_t)records.size();
+		header.objectsOffset = sizeof(SceneHeader);
+		header.stringsOffset = header.objectsOffset + records.size() * sizeof(SceneObjectRecord);
+		header.stringsSize = strings.size();
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file) return false;
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)records.data(), records.size() * sizeof(SceneObjectRecord));
+		file.write(strings.data(), strings.size());
+		return (bool)file;
+	}
+
+	/*****************************************************
+	* A scene file mapped into memory.
+	*
+	* The mapping is copy-on-write, so the pointer fix-up
+	* on load never touches the file on disk.
+	*****************************************************/
+	class MappedScene
+	{
+	private:
+		char* base = nullptr;
+		size_t size = 0;
+		SceneObjectRecord* records = nullptr;
+		uint32_t count = 0;
+#if _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#endif
+
+		bool Map(_In_z_ const char* path)
+		{
+#if _WIN32
+			file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return false;
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return false;
+			size = (size_t)fileSize.QuadPart;
+			mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			if (!mapping) return false;
+			base = (char*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			return !!base;
+#else
+			int fd = open(path, O_RDONLY);
+			if (fd < 0) return false;
+			struct stat info;
+			if (fstat(fd, &info) != 0 || info.st_size == 0)
+			{
+				close(fd);
+				return false;
+			}
+			size = (size_t)info.st_size;
+			void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if (view == MAP_FAILED) return false;
+			base = (char*)view;
+			return true;
+#endif
+		}
+
+		bool Validate() const
+		{
+			if (size < sizeof(SceneHeader)) return false;
+			const SceneHeader& header = *(const SceneHeader*)base;
+			if (header.magic != SceneHeader::magicValue) return false;
+			if (header.version != SceneHeader::currentVersion) return false;
+			// Both terms fit in 32 bits, so this can't overflow; the strings range is checked without adding
+			uint64_t recordsEnd = (uint64_t)header.objectsOffset + (uint64_t)header.objectCount * sizeof(SceneObjectRecord);
+			if (header.objectsOffset < sizeof(SceneHeader)) return false;
+			if (header.objectsOffset % alignof(SceneObjectRecord) != 0) return false;
+			if (recordsEnd > header.stringsOffset) return false;
+			if (header.stringsOffset > size || header.stringsSize > size - header.stringsOffset) return false;
+			return true;
+		}
+
+		// Turns every record's name offset into a pointer into the mapping
+		bool FixUp()
+		{
+			const SceneHeader& header = *(const SceneHeader*)base;
+			records = (SceneObjectRecord*)(base + header.objectsOffset);
+			count = header.objectCount;
+			const char* strings = base + header.stringsOffset;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint64_t offset = records[i].nameOffset;
+				// Written to not overflow, since both come from the file
+				if (offset >= header.stringsSize || records[i].nameLength >= header.stringsSize - offset) return false;
+				records[i].name = strings + offset;
+			}
+			return true;
+		}
+
+	public:
+		MappedScene() = default;
+		MappedScene(const MappedScene&) = delete;
+		MappedScene& operator=(const MappedScene&) = delete;
+		~MappedScene() { Close(); }
+
+		// Returns false, leaving the scene empty, if the file is missing or not a valid scene
+		bool Open(_In_z_ const char* path)
+		{
+			Close();
+			if (Map(path) && Validate() && FixUp()) return true;
+			Close();
+			return false;
+		}
+		void Close()
+		{
+#if _WIN32
+			if (base) UnmapViewOfFile(base);
+			if (mapping) CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+			mapping = nullptr;
+			file = INVALID_HANDLE_VALUE;
+#else
+			if (base) munmap(base, size);
+#endif
+			base = nullptr;
+			size = 0;
+			records = nullptr;
+			count = 0;
+		}
+
+		bool IsOpen() const { return !!base; }
+		size_t GetObjectCount() const { return count; }
+		const SceneObjectRecord& operator[](size_t index) const { return records[index]; }
+		std::span<const SceneObjectRecord> GetObjects() const { return { records, count }; }
+
+		// Creates a live Object for every record
+		void Instantiate(std::vector<Object*>& objects) const
+		{
+			objects.reserve(objects.size() + count);
+			for (const SceneObjectRecord& record : GetObjects())
+			{
+				Object* object = new Object();
+				object->SetName(string(record.GetName()));
+				object->SetHideFlags(record.GetHideFlags());
+				objects.push_back(object);
+			}
+		}
+	};
+
+	// Text format, one "hideFlags name" line per object.
+	// Kept as the baseline the binary format is measured against.
+	inline bool SaveSceneText(_In_z_ const char* path, std::span<const Object* const> objects, SceneTarget target)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file) return false;
+		for (const Object* object : objects)
+		{
+			if (!object || !ShouldSave(*object, target)) continue;
+			file << (int)object->GetHideFlags() << ' ' << object->GetName() << '\n';
+		}
+		return (bool)file;
+	}
+	inline bool LoadSceneText(_In_z_ const char* path, std::vector<Object*>& objects)
+	{
+		std::ifstream file(path);
+		if (!file) return false;
+		int hideFlags;
+		string name;
+		while (file >> hideFlags)
+		{
+			file.get(); // Separator
+			std::getline(file, name);
+			Object* object = new Object();
+			object->SetName(name);
+			object->SetHideFlags((HideFlags)hideFlags);
+			objects.push_back(object);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,380 @@
+#pragma once
+#include <vector>
+#include "Engine.Core.h"
+
+namespace Engine
+{
+	/********************************************************
+	* Dynamic AABB tree of Rects for overlap and containment
+	* queries in O(log n) instead of testing every pair.
+	*
+	* Each leaf stores the exact rect it was given, plus a
+	* "fat" rect padded by margin. Moves that stay inside
+	* the fat rect don't touch the tree at all.
+	********************************************************/
+	class RectTree
+	{
+	public:
+		static constexpr int nullProxy = -1;
+
+	private:
+		// Plain min/max box, so traversal doesn't go through Rect's accessors
+		struct Bounds
+		{
+			float xMin, yMin, xMax, yMax;
+
+			Bounds() = default;
+			Bounds(float xMin, float yMin, float xMax, float yMax) : xMin(xMin), yMin(yMin), xMax(xMax), yMax(yMax) {}
+			Bounds(const Rect& rect) : xMin(rect.GetXMin()), yMin(rect.GetYMin()), xMax(rect.GetXMax()), yMax(rect.GetYMax()) {}
+
+			float Perimeter() const { return 2.0f * ((xMax - xMin) + (yMax - yMin)); }
+			bool Contains(const Bounds& other) const
+			{
+				return xMin <= other.xMin && yMin <= other.yMin && other.xMax <= xMax && other.yMax <= yMax;
+			}
+			// Inclusive, so that it is conservative for both Rect::Overlaps and Rect::Contains
+			bool Touches(const Bounds& other) const
+			{
+				return xMin <= other.xMax && other.xMin <= xMax && yMin <= other.yMax && other.yMin <= yMax;
+			}
+			bool Touches(float x, float y) const
+			{
+				return xMin <= x && x <= xMax && yMin <= y && y <= yMax;
+			}
+
+			static Bounds Union(const Bounds& a, const Bounds& b)
+			{
+				return { std::min(a.xMin, b.xMin), std::min(a.yMin, b.yMin), std::max(a.xMax, b.xMax), std::max(a.yMax, b.yMax) };
+			}
+		};
+
+		struct Node
+		{
+			Bounds fat;
+			Bounds tight; // Only meaningful for leaves
+			void* userData;
+			int parent; // Doubles as the next link while the node is on the free list
+			int child1, child2;
+			int height; // 0 for leaves, -1 for free nodes
+
+			bool IsLeaf() const { return child1 == nullProxy; }
+		};
+
+		std::vector<Node> nodes;
+		int root = nullProxy;
+		int freeList = nullProxy;
+		int proxyCount = 0;
+		float margin;
+
+		int AllocateNode()
+		{
+			if (freeList == nullProxy)
+			{
+				nodes.emplace_back();
+				nodes.back().parent = nullProxy;
+				freeList = (int)nodes.size() - 1;
+			}
+			int id = freeList;
+			Node& node = nodes[id];
+			freeList = node.parent;
+			node.parent = nullProxy;
+			node.child1 = nullProxy;
+			node.child2 = nullProxy;
+			node.height = 0;
+			node.userData = nullptr;
+			return id;
+		}
+		void FreeNode(int id)
+		{
+			nodes[id].parent = freeList;
+			nodes[id].height = -1;
+			freeList = id;
+		}
+
+		void InsertLeaf(int leaf)
+		{
+			if (root == nullProxy)
+			{
+				root = leaf;
+				nodes[root].parent = nullProxy;
+				return;
+			}
+
+			// Descend towards the sibling that grows the tree's total perimeter the least
+			Bounds leafBounds = nodes[leaf].fat;
+			int index = root;
+			while (!nodes[index].IsLeaf())
+			{
+				const Node& node = nodes[index];
+				float perimeter = node.fat.Perimeter();
+				float combinedPerimeter = Bounds::Union(node.fat, leafBounds).Perimeter();
+
+				// Cost of making a new parent for this node and the leaf
+				float cost = 2.0f * combinedPerimeter;
+				// Minimum cost of pushing the leaf further down
+				float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+				auto descendCost = [&](int child)
+				{
+					float grown = Bounds::Union(leafBounds, nodes[child].fat).Perimeter();
+					if (nodes[child].IsLeaf()) return grown + inheritanceCost;
+					return (grown - nodes[child].fat.Perimeter()) + inheritanceCost;
+				};
+				float cost1 = descendCost(node.child1);
+				float cost2 = descendCost(node.child2);
+
+				if (cost < cost1 && cost < cost2) break;
+				index = (cost1 < cost2) ? node.child1 : node.child2;
+			}
+			int sibling = index;
+
+			int oldParent = nodes[sibling].parent;
+			int newParent = AllocateNode();
+			nodes[newParent].parent = oldParent;
+			nodes[newParent].fat = Bounds::Union(leafBounds, nodes[sibling].fat);
+			nodes[newParent].height = nodes[sibling].height + 1;
+			nodes[newParent].child1 = sibling;
+			nodes[newParent].child2 = leaf;
+			nodes[sibling].parent = newParent;
+			nodes[leaf].parent = newParent;
+
+			if (oldParent == nullProxy)
+				root = newParent;
+			else if (nodes[oldParent].child1 == sibling)
+				nodes[oldParent].child1 = newParent;
+			else
+				nodes[oldParent].child2 = newParent;
+
+			Refit(nodes[leaf].parent);
+		}
+
+		void RemoveLeaf(int leaf)
+		{
+			if (leaf == root)
+			{
+				root = nullProxy;
+				return;
+			}
+
+			int parent = nodes[leaf].parent;
+			int grandParent = nodes[parent].parent;
+			int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+			FreeNode(parent);
+			nodes[sibling].parent = grandParent;
+			if (grandParent == nullProxy)
+			{
+				root = sibling;
+				return;
+			}
+
+			if (nodes[grandParent].child1 == parent)
+				nodes[grandParent].child1 = sibling;
+			else
+				nodes[grandParent].child2 = sibling;
+			Refit(grandParent);
+		}
+
+		// Walks up from index, rebalancing and recomputing bounds and heights
+		void Refit(int index)
+		{
+			while (index != nullProxy)
+			{
+				index = Balance(index);
+				Node& node = nodes[index];
+				const Node& a = nodes[node.child1];
+				const Node& b = nodes[node.child2];
+				node.height = 1 + std::max(a.height, b.height);
+				node.fat = Bounds::Union(a.fat, b.fat);
+				index = node.parent;
+			}
+		}
+
+		// Performs a single left or right rotation if the subtree at a is imbalanced.
+		// Returns the new root of the subtree.
+		int Balance(int a)
+		{
+			Node& A = nodes[a];
+			if (A.IsLeaf() || A.height < 2) return a;
+
+			int b = A.child1;
+			int c = A.child2;
+			int balance = nodes[c].height - nodes[b].height;
+
+			if (balance > 1) return Rotate(a, c, b);
+			if (balance < -1) return Rotate(a, b, c);
+			return a;
+		}
+		// Promotes the taller child "up" above a; "other" stays where it is
+		int Rotate(int a, int up, int other)
+		{
+			Node& A = nodes[a];
+			Node& U = nodes[up];
+			int f = U.child1;
+			int g = U.child2;
+
+			// Swap a and up
+			U.child1 = a;
+			U.parent = A.parent;
+			A.parent = up;
+
+			if (U.parent == nullProxy)
+				root = up;
+			else if (nodes[U.parent].child1 == a)
+				nodes[U.parent].child1 = up;
+			else
+				nodes[U.parent].child2 = up;
+
+			// Keep the taller grandchild under up, hand the shorter one to a
+			int keep = f, give = g;
+			if (nodes[f].height < nodes[g].height) { keep = g; give = f; }
+
+			U.child2 = keep;
+			if (A.child1 == up) A.child1 = give; else A.child2 = give;
+			nodes[give].parent = a;
+
+			A.fat = Bounds::Union(nodes[other].fat, nodes[give].fat);
+			U.fat = Bounds::Union(A.fat, nodes[keep].fat);
+			A.height = 1 + std::max(nodes[other].height, nodes[give].height);
+			U.height = 1 + std::max(A.height, nodes[keep].height);
+			return up;
+		}
+
+		Bounds Fatten(const Bounds& bounds) const
+		{
+			return { bounds.xMin - margin, bounds.yMin - margin, bounds.xMax + margin, bounds.yMax + margin };
+		}
+
+		template<class _Test, class _Accept>
+		size_t Traverse(_Test&& test, _Accept&& accept, _Out_writes_to_(capacity, return) int* results, size_t capacity) const
+		{
+			if (root == nullProxy || capacity == 0) return 0;
+
+			// The tree is AVL-balanced, so this comfortably covers any realistic leaf count
+			int stack[128];
+			std::vector<int> overflow;
+			int top = 0;
+			size_t found = 0;
+
+			stack[top++] = root;
+			while (top > 0 || !overflow.empty())
+			{
+				int index;
+				if (!overflow.empty()) { index = overflow.back(); overflow.pop_back(); }
+				else index = stack[--top];
+
+				const Node& node = nodes[index];
+				if (!test(node.fat)) continue;
+
+				if (node.IsLeaf())
+				{
+					if (!accept(node.tight)) continue;
+					results[found++] = index;
+					if (found == capacity) break;
+				}
+				else
+				{
+					for (int child : { node.child1, node.child2 })
+					{
+						if (top < (int)std::size(stack)) stack[top++] = child;
+						else overflow.push_back(child);
+					}
+				}
+			}
+			return found;
+		}
+
+	public:
+		// margin: How far a rect may move before its proxy needs to be reinserted
+		RectTree(float margin = 4.0f) : margin(margin) {}
+
+		int GetProxyCount() const { return proxyCount; }
+		int GetHeight() const { return (root == nullProxy) ? 0 : nodes[root].height; }
+
+		_Ret_maybenull_ void* GetUserData(int proxy) const
+		{
+			_ASSERT_EXPR(nodes[proxy].height == 0, L"Not a live proxy");
+			return nodes[proxy].userData;
+		}
+		Rect GetRect(int proxy) const
+		{
+			const Bounds& b = nodes[proxy].tight;
+			return Rect::MinMaxRect(b.xMin, b.yMin, b.xMax, b.yMax);
+		}
+
+		// Returns the proxy id used to move, remove and identify the rect in query results
+		int Insert(Rect rect, _In_opt_ void* userData = nullptr)
+		{
+			int proxy = AllocateNode();
+			Node& node = nodes[proxy];
+			node.tight = Bounds(rect);
+			node.fat = Fatten(node.tight);
+			node.userData = userData;
+			InsertLeaf(proxy);
+			++proxyCount;
+			return proxy;
+		}
+
+		void Remove(int proxy)
+		{
+			_ASSERT_EXPR(nodes[proxy].height == 0, L"Not a live proxy");
+			RemoveLeaf(proxy);
+			FreeNode(proxy);
+			--proxyCount;
+		}
+
+		// Updates the proxy's rect. displacement is the expected motion for the next
+		// frame, used to stretch the fat rect in that direction.
+		// Returns true if the proxy had to be reinserted.
+		bool Move(int proxy, Rect rect, Vector2 displacement = Vector2(0, 0))
+		{
+			_ASSERT_EXPR(nodes[proxy].height == 0, L"Not a live proxy");
+			Node& node = nodes[proxy];
+			node.tight = Bounds(rect);
+			if (node.fat.Contains(node.tight)) return false;
+
+			RemoveLeaf(proxy);
+
+			Bounds fat = Fatten(node.tight);
+			constexpr float displacementScale = 2.0f;
+			float dx = displacementScale * displacement.GetX();
+			float dy = displacementScale * displacement.GetY();
+			if (dx < 0.0f) fat.xMin += dx; else fat.xMax += dx;
+			if (dy < 0.0f) fat.yMin += dy; else fat.yMax += dy;
+			nodes[proxy].fat = fat;
+
+			InsertLeaf(proxy);
+			return true;
+		}
+
+		// Writes up to capacity proxies whose rect overlaps area (as Rect::Overlaps).
+		// Returns the number written.
+		size_t Query(Rect area, _Out_writes_to_(capacity, return) int* results, size_t capacity) const
+		{
+			Bounds a(area);
+			return Traverse(
+				[&](const Bounds& b) { return b.Touches(a); },
+				[&](const Bounds& b) { return a.xMin < b.xMax && a.xMax > b.xMin && a.yMin < b.yMax && a.yMax > b.yMin; },
+				results, capacity);
+		}
+
+		// Writes up to capacity proxies whose rect contains point (as Rect::Contains).
+		// Returns the number written.
+		size_t Query(Vector2 point, _Out_writes_to_(capacity, return) int* results, size_t capacity) const
+		{
+			float x = point.GetX(), y = point.GetY();
+			return Traverse(
+				[&](const Bounds& b) { return b.Touches(x, y); },
+				[&](const Bounds& b) { return b.Touches(x, y); },
+				results, capacity);
+		}
+
+		void Clear()
+		{
+			nodes.clear();
+			root = nullProxy;
+			freeList = nullProxy;
+			proxyCount = 0;
+		}
+	};
+}
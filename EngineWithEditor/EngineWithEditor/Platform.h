@@ -0,0 +1,46 @@
+#pragma once
+// Stand-ins for the MSVC extensions the engine core is written with,
+// so that the core also builds with GCC and Clang.
+
+#if defined(_MSC_VER)
+#include <sal.h>
+#include <crtdbg.h>
+
+#define ENGINE_PROPERTIES 1
+#define ENGINE_ALLOCATOR __declspec(allocator)
+
+#else
+#include <cassert>
+
+#define ENGINE_PROPERTIES 0
+#define ENGINE_ALLOCATOR
+
+// SAL annotations only document intent outside of MSVC
+#define _In_
+#define _In_z_
+#define _In_opt_
+#define _In_reads_(size)
+#define _Out_
+#define _Out_writes_to_(size, count)
+#define _Ret_
+#define _Ret_opt_
+#define _Ret_maybenull_
+
+#define _ASSERT_EXPR(expr, msg) assert((expr) && msg)
+#define _ASSERTE(expr) assert(expr)
+
+#define __interface struct
+#endif
+
+// Properties (obj.x instead of obj.GetX()) need __declspec(property).
+// Elsewhere a property is declared as a deprecated static member that is never defined,
+// so any use warns at compile time and fails to link. Portable code calls Get/Set directly.
+#if ENGINE_PROPERTIES
+#define RO(get_func_name) __declspec(property(get = get_func_name))
+#define WO(set_func_name) __declspec(property(put = set_func_name))
+#define RW(get_func_name, set_func_name) __declspec(property(get = get_func_name, put = set_func_name))
+#else
+#define RO(get_func_name) [[deprecated("Properties need MSVC; call " #get_func_name "() instead")]] static
+#define WO(set_func_name) [[deprecated("Properties need MSVC; call " #set_func_name "() instead")]] static
+#define RW(get_func_name, set_func_name) [[deprecated("Properties need MSVC; call " #get_func_name "()/" #set_func_name "() instead")]] static
+#endif
@@ -1,7 +1,7 @@
 #pragma once
-#include <sal.h>
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <vector>
 #include <deque>
 #include <forward_list>
@@ -12,6 +12,7 @@
 #include <map>
 #include <unordered_set>
 #include <unordered_map>
+#include "Platform.h"
 
 using byte = char;
 constexpr size_t KILOBYTE = 1024;
@@ -67,10 +68,10 @@ namespace hw
 		{
 			_ASSERT_EXPR(blockIndex + 1 < _ControllerCapacity, L"Insufficient capacity for memory block shift");
 			Block* block = controller + blockIndex;
-			size_t srcSize = validBlocks - blockIndex;
-			size_t destSize = _ControllerCapacity - blockIndex;
-			if (memmove_s(block + 1, destSize, block, srcSize) == 0)
-				++validBlocks;
+			size_t srcCount = validBlocks - blockIndex;
+			_ASSERT_EXPR(validBlocks < _ControllerCapacity, L"Insufficient capacity for memory block shift");
+			std::memmove(block + 1, block, srcCount * sizeof(Block));
+			++validBlocks;
 		}
 
 		inline void _SubdivideBlock(size_t blockIndex, size_t size)
@@ -106,7 +107,7 @@ namespace hw
 			bool anyChanges = false;
 			while (IsValidBlock(startIndex))
 			{
-				for (startIndex; IsValidBlock(startIndex); ++startIndex)
+				for (; IsValidBlock(startIndex); ++startIndex)
 				{
 					if (!controller[startIndex].inUse) break;
 				}
@@ -170,7 +171,7 @@ namespace hw
 		}
 
 		// It is safe to free freed memory
-		void Deallocate(_In_ void* const _Ptr, const size_t _Count)
+		void Deallocate(_In_ void* const _Ptr, [[maybe_unused]] const size_t _Count)
 		{
 			Block* block = FindBlockByStart(_Ptr);
 			if (!block) return _ASSERT_EXPR(false, L"tried to deallocate definitely unowned block");
@@ -178,7 +179,7 @@ namespace hw
 			block->inUse = false;
 			Defrag();
 		}
-		__declspec(allocator) _Ret_ void* Allocate(const size_t _Count) noexcept(false)
+		ENGINE_ALLOCATOR _Ret_ void* Allocate(const size_t _Count) noexcept(false)
 		{
 			Block* block = FindFreeBlock(_Count);
 			if (!block) throw std::bad_alloc();
@@ -187,11 +188,11 @@ namespace hw
 		}
 	};
 
-	void _Dealloc(_In_ void* const _Ptr, const size_t _Count)
+	inline void _Dealloc(_In_ void* const _Ptr, const size_t _Count)
 	{
 		Memory::GetSingleton().Deallocate(_Ptr, _Count);
 	}
-	__declspec(allocator) _Ret_ void* _Alloc(const size_t _Count) noexcept(false)
+	inline ENGINE_ALLOCATOR _Ret_ void* _Alloc(const size_t _Count) noexcept(false)
 	{
 		return Memory::GetSingleton().Allocate(_Count);
 	}
@@ -1,7 +1,14 @@
 #include <fstream>
 #include "containers.h"
+#include "Engine.Assets.h"
 #include "Debug.h"
 #include "EditorUI.h"
+#include "EditorUI.Docking.h"
+#include "EditorUI.HitTest.h"
+#include "EditorUI.PaneCache.h"
+#include "EditorUI.ProfilerView.h"
+#include "EditorUI.TreeView.h"
+#include "Engine.Profiler.h"
 
 using namespace EditorUI;
 using namespace Engine;
@@ -15,15 +22,26 @@ int main()
 	rl::InitWindow(1280, 720, "Henry's Editor");
 	rl::SetTargetFPS(60);
 
+	AssetCache<rl::Texture> textures([](strcref path) { return rl::LoadTexture(path.c_str()); }, rl::UnloadTexture);
+	AssetCache<rl::Shader> shaders([](strcref path) { return rl::LoadShader(0, path.c_str()); }, rl::UnloadShader);
+
+	DrawList drawList;
+	PaneCache paneCache;
+
+	AssetCache<rl::Texture>::Handle uiTextureHandle;
 	{
-		rl::Image defaultImg = rl::GenImageColor(1, 1, rl::WHITE);
-		uiTexture = rl::LoadTextureFromImage(defaultImg);
-		rl::UnloadImage(defaultImg);
+		rl::Image uiImage = GenUITextureImage();
+		uiTextureHandle = textures.Insert("builtin:ui", rl::LoadTextureFromImage(uiImage), HideFlags::DontUnloadUnusedAsset);
+		rl::UnloadImage(uiImage);
 	}
+	uiTexture = *uiTextureHandle;
+	rl::SetTextureWrap(uiTexture, rl::TEXTURE_WRAP_REPEAT);
+	rl::SetTextureFilter(uiTexture, rl::TEXTURE_FILTER_POINT);
+	drawList.SetShapesTexture(uiTexture, { 0,0,1,1 });
+	paneCache.SetShapesTexture(uiTexture, { 0,0,1,1 });
 
-	previewShader = rl::LoadShader(0, "preview.frag");
-	gripShader = rl::LoadShader(0, "grip.frag");
-	gripShaderSizeLoc = rl::GetShaderLocation(gripShader, "size");
+	AssetCache<rl::Shader>::Handle previewShaderHandle = shaders.Load("preview.frag", HideFlags::DontUnloadUnusedAsset);
+	previewShader = *previewShaderHandle;
 
 	hw::vector<Pane*> panes;
 	panes.reserve(8);
@@ -31,24 +49,210 @@ int main()
 	panes.push_back(hw::New<Pane>("Test2", true));
 	panes.back()->Move({50,0});
 
+	// Placeholder hierarchy until scenes have one, large enough to show the tree only drawing what is on screen
+	TreeView hierarchy;
+	for (int group = 0; group < 1000; ++group)
+	{
+		TreeView::NodeId parent = hierarchy.AddNode("Group " + std::to_string(group));
+		for (int child = 0; child < 100; ++child)
+		{
+			hierarchy.AddNode("Object " + std::to_string(group * 100 + child), parent);
+		}
+	}
+	panes.push_back(hw::New<Pane>("Hierarchy", false));
+	panes.back()->SetRect({ 200, 50, 220, 400 });
+	panes.back()->content = &hierarchy;
+
+	Profiler::SetEnabled(true);
+	ProfilerView profilerView;
+	panes.push_back(hw::New<Pane>("Profiler", false));
+	Pane* profilerPane = panes.back();
+	profilerPane->SetRect({ 440, 50, 300, 260 });
+	profilerPane->content = &profilerView;
+
 	Pane* focusedPane = nullptr;
+	PaneInteractFlags focusedFlags = PaneInteractFlags(0);
+	HitGrid hitGrid;
+	DockTree dockTree;
+	dockTree.SetArea({ 0, 0, (float)rl::GetScreenWidth(), (float)rl::GetScreenHeight() });
+	InputQueue input;
+	HitGrid::Hit hover = {};
+	DockTree::Target dockPreview = {}; // Where the dragged pane would dock if dropped now
+	bool layoutChanged = true;
+	bool toggleTrace = false; // Applied between frames, so a trace never holds half a frame
+
+	// Panes only move while being dragged or resized, so the grid is only rebuilt after that
+	auto HitTest = [&](rl::Vector2 point)
+	{
+		ENGINE_PROFILE_SCOPE("Hit test");
+		if (layoutChanged)
+		{
+			hitGrid.Clear();
+			for (size_t i = 0; i < panes.size(); ++i)
+			{
+				hitGrid.AddPane(*panes[i], (int)i);
+			}
+			layoutChanged = false;
+		}
+		return hitGrid.HitTest(point);
+	};
+
+	// Sleep in EndDrawing until there is input, instead of redrawing an unchanged editor every frame
+	rl::EnableEventWaiting();
+	Debug::TraceThreadName("Main");
 	while (!rl::WindowShouldClose())
 	{
-		
+		Profiler::BeginFrame();
+		Debug::TraceBegin("Frame");
+		input.Poll();
+
+		InputEvent event;
+		while (input.Pop(event))
+		{
+			ENGINE_PROFILE_SCOPE("Handle input");
+			switch (event.type)
+			{
+			case InputEvent::Type::windowResize:
+				dockTree.SetArea({ 0, 0, (float)rl::GetScreenWidth(), (float)rl::GetScreenHeight() });
+				layoutChanged = true;
+				break;
+
+			case InputEvent::Type::mouseDown:
+				if (event.code != rl::MOUSE_LEFT_BUTTON) break;
+				hover = HitTest(event.position);
+				focusedPane = hover ? panes[hover.owner] : nullptr;
+				focusedFlags = focusedPane ? focusedPane->HandleEvent(event, hover.region, focusedFlags) : PaneInteractFlags(0);
+				if (focusedPane && focusedPane->content && hover.region == Pane::HoverRegion::hovering &&
+					focusedPane->content->HandleEvent(event, focusedPane->GetContentRect()))
+				{
+					focusedPane->Invalidate();
+				}
+				// Dragging a docked pane tears it out of the layout
+				if (!!(focusedFlags & PaneInteractFlags::beingDragged) && dockTree.IsDocked(*focusedPane))
+				{
+					dockTree.Undock(*focusedPane);
+					layoutChanged = true;
+				}
+				break;
+
+			case InputEvent::Type::mouseUp:
+				if (event.code != rl::MOUSE_LEFT_BUTTON || !focusedPane) break;
+				if (!!(focusedFlags & PaneInteractFlags::beingDragged))
+				{
+					DockTree::Target target = dockTree.FindTarget(event.position);
+					if (target)
+					{
+						dockTree.Dock(*focusedPane, target);
+						layoutChanged = true;
+					}
+				}
+				focusedFlags = focusedPane->HandleEvent(event, hover.region, focusedFlags);
+				dockPreview = {};
+				break;
+
+			case InputEvent::Type::mouseMove:
+				if (focusedPane && !!(focusedFlags & (PaneInteractFlags::beingDragged | PaneInteractFlags::resizingX | PaneInteractFlags::resizingY)))
+				{
+					if (dockTree.IsDocked(*focusedPane))
+					{
+						// Docked panes are resized by moving the split they share with their neighbour
+						rl::Vector2 resizeDelta = event.delta;
+						if (!(focusedFlags & PaneInteractFlags::resizingX)) resizeDelta.x = 0;
+						if (!(focusedFlags & PaneInteractFlags::resizingY)) resizeDelta.y = 0;
+						dockTree.Resize(*focusedPane, resizeDelta);
+					}
+					else
+					{
+						focusedFlags = focusedPane->HandleEvent(event, hover.region, focusedFlags);
+					}
+					layoutChanged = true;
+					if (!!(focusedFlags & PaneInteractFlags::beingDragged)) dockPreview = dockTree.FindTarget(event.position);
+				}
+				else
+				{
+					// The hovered region only matters for the cursor while nothing is being dragged
+					hover = HitTest(event.position);
+				}
+				break;
+
+			// Scrolling goes to the pane under the cursor, keys to the focused one
+			case InputEvent::Type::mouseWheel:
+			{
+				HitGrid::Hit hit = HitTest(event.position);
+				Pane* pane = hit ? panes[hit.owner] : nullptr;
+				if (pane && pane->content && pane->content->HandleEvent(event, pane->GetContentRect())) pane->Invalidate();
+				break;
+			}
+			case InputEvent::Type::keyDown:
+				// F9 records a trace of the frames until it is pressed again
+				if (event.code == rl::KEY_F9)
+				{
+					toggleTrace = !toggleTrace;
+					break;
+				}
+				if (focusedPane && focusedPane->content && focusedPane->content->HandleEvent(event, focusedPane->GetContentRect()))
+				{
+					focusedPane->Invalidate();
+				}
+				break;
+
+			default: break;
+			}
+		}
+
+		cursorShapeMode = CursorShapeMode::none;
+		UpdateCursorShapeModeWithoutOverride(hover.region);
 
 		// Draw
 		rl::BeginDrawing();
 		{
+			ENGINE_PROFILE_SCOPE("Draw");
 			rl::ClearBackground(Theme::color_main);
 
-			
+			// The focused pane changes with every interaction, so only the others are cached
+			paneCache.BeginFrame();
+			for (Pane* pane : panes)
+			{
+				if (pane == focusedPane) pane->DrawFocused(drawList, focusedFlags);
+				else paneCache.Draw(drawList, *pane);
+			}
+			if (dockPreview)
+			{
+				rl::Color previewColor = Theme::color_highlight;
+				previewColor.a = 64;
+				drawList.DrawRectangle(dockTree.GetTargetRect(dockPreview), previewColor);
+			}
+			drawList.Submit();
+			// Cached panes on one atlas page share a batch, so draw calls should stay near the page count
+			PaneCache::FrameStats cacheStats = paneCache.GetFrameStats();
+			Debug::TraceCounter("Draw calls", (double)drawList.GetLastBatchCount());
+			Debug::TraceCounter("Pane cache hits", (double)cacheStats.hits);
+			Debug::TraceCounter("Pane cache misses", (double)cacheStats.misses);
+			Debug::TraceCounter("Pane cache pages", (double)cacheStats.pages);
+			textCache.EvictUnused(textCacheMaxAge);
+		}
+		Debug::TraceEnd("Frame");
+		Debug::TraceFlush();
+		if (toggleTrace)
+		{
+			if (Debug::IsTracing()) Debug::TraceStop();
+			else if (!Debug::TraceStart("editor.trace.json")) DEBUG_LOG_ERROR("Couldn't create {}", "editor.trace.json");
+			toggleTrace = false;
 		}
+		// Before EndDrawing, which waits for vsync and then for input
+		Profiler::EndFrame();
+		profilerView.Update();
+		profilerPane->Invalidate();
 		rl::EndDrawing();
 	}
 
-	rl::UnloadShader(gripShader);
-	rl::UnloadShader(previewShader);
-	rl::UnloadTexture(uiTexture);
+	Debug::TraceStop();
+	paneCache.Clear();
+	textCache.Clear();
+	previewShaderHandle.Reset();
+	uiTextureHandle.Reset();
+	shaders.UnloadAll();
+	textures.UnloadAll();
 
 	rl::CloseWindow();
 